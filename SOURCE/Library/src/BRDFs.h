@@ -1,6 +1,8 @@
 #pragma once
 #include "Math.h"
 #include "ColorRGB.h"
+#include "FastMath.h"
+#include "SIMD.h"
 #include "Vector3.h"
 
 namespace dae
@@ -29,15 +31,63 @@ namespace dae
 		 * \param l Incoming (incident) Light Direction
 		 * \param v View Direction
 		 * \param n Normal of the Surface
+		 * \param precision Accuracy of the pow evaluation (see FastMath.h)
 		 * \return Phong Specular Color
 		 */
-		static ColorRGB Phong(const ColorRGB& ks, float exp, const Vector3& l, const Vector3& v, const Vector3& n)
+		static ColorRGB Phong(const ColorRGB& ks, float exp, const Vector3& l, const Vector3& v, const Vector3& n, PowPrecision precision)
 		{
 			const float cosA{ Vector3::Dot(Vector3::Reflect(l, n), v) };
 
 			if (cosA < FLT_EPSILON) return {};
 
-			return ks * powf(cosA, exp);
+			return ks * FastPow(cosA, exp, precision);
+		}
+
+		static ColorRGB Phong(const ColorRGB& ks, float exp, const Vector3& l, const Vector3& v, const Vector3& n)
+		{
+			return Phong(ks, exp, l, v, n, PowPrecision::Exact);
+		}
+
+		/**
+		 * \param ks Specular Reflection Coefficient
+		 * \param exp Specular Exponent
+		 * \param l Incoming (incident) Light Direction
+		 * \param v View Direction
+		 * \param n Normal of the Surface
+		 * \param precision Accuracy of the pow evaluation (see FastMath.h)
+		 * \return Blinn-Phong Specular Color
+		 */
+		static ColorRGB BlinnPhong(const ColorRGB& ks, float exp, const Vector3& l, const Vector3& v, const Vector3& n, PowPrecision precision = PowPrecision::Exact)
+		{
+			const Vector3 halfVector{ (l - v).Normalized() };
+			const float cosA{ Vector3::Dot(n, halfVector) };
+
+			if (cosA < FLT_EPSILON) return {};
+
+			return ks * FastPow(cosA, exp, precision);
+		}
+
+		/* --- SIMD_WIDTH lanes at once, same conventions as the scalar versions --- */
+		static ColorRGBx4 Lambert(const ColorRGBx4& kd, const ColorRGBx4& cd)
+		{
+			return cd * kd * _mm_set1_ps(DIV_PI);
+		}
+
+		static ColorRGBx4 Phong(const ColorRGBx4& ks, __m128 exp, const Vector3x4& l, const Vector3x4& v, const Vector3x4& n, PowPrecision precision)
+		{
+			const __m128 cosA{ Vector3x4::Dot(Vector3x4::Reflect(l, n), v) };
+			const __m128 lit{ _mm_cmpge_ps(cosA, _mm_set1_ps(FLT_EPSILON)) };
+
+			return ks * _mm_and_ps(lit, FastPow(cosA, exp, precision));
+		}
+
+		static ColorRGBx4 BlinnPhong(const ColorRGBx4& ks, __m128 exp, const Vector3x4& l, const Vector3x4& v, const Vector3x4& n, PowPrecision precision)
+		{
+			const Vector3x4 halfVector{ (l - v).Normalized() };
+			const __m128 cosA{ Vector3x4::Dot(n, halfVector) };
+			const __m128 lit{ _mm_cmpge_ps(cosA, _mm_set1_ps(FLT_EPSILON)) };
+
+			return ks * _mm_and_ps(lit, FastPow(cosA, exp, precision));
 		}
 	}
 }
\ No newline at end of file
@@ -41,6 +41,7 @@ namespace dae
 		Matrix invViewMatrix{};
 		Matrix viewMatrix{};
 		Matrix projectionMatrix{};
+		Matrix reversedZProjectionMatrix{};
 
 		float far{};
 		float near{};
@@ -73,9 +74,37 @@ namespace dae
 			//DirectX Implementation => https://learn.microsoft.com/en-us/windows/win32/direct3d9/d3dxmatrixlookatlh
 		}
 
+		// programmatic camera, pitch and yaw in degrees like the mouse look
+		void SetView(const Vector3& _origin, float pitch, float yaw)
+		{
+			origin = _origin;
+			totalPitch = pitch;
+			totalYaw = yaw;
+
+			CalculateViewMatrix();
+		}
+
+		void LookAt(const Vector3& _origin, const Vector3& target)
+		{
+			// forward of (pitch, yaw) is (cos pitch * sin yaw, -sin pitch, cos pitch * cos yaw)
+			const Vector3 direction{ target - _origin };
+			const float horizontalLength{ sqrtf(direction.x * direction.x + direction.z * direction.z) };
+
+			SetView(_origin, atan2f(-direction.y, horizontalLength) * TO_DEGREES, atan2f(direction.x, direction.z) * TO_DEGREES);
+		}
+
+		void SetFov(float _fovAngle)
+		{
+			fovAngle = _fovAngle;
+			fovValue = tanf((fovAngle * TO_RADIANS) * 0.5f);
+
+			CalculateProjectionMatrix();
+		}
+
 		void CalculateProjectionMatrix()
 		{
 			projectionMatrix = Matrix::CreatePerspectiveFovLH(fovValue, aspectRatio, near, far);
+			reversedZProjectionMatrix = Matrix::CreatePerspectiveFovLHReversedZ(fovValue, aspectRatio, near, far);
 
 			//DirectX Implementation => https://learn.microsoft.com/en-us/windows/win32/direct3d9/d3dxmatrixperspectivefovlh
 		}
@@ -3,6 +3,7 @@
 #define DATATYPES_H
 
 #include "Maths.h"
+#include "SIMD.h"
 #include <vector>
 
 namespace dae
@@ -61,6 +62,17 @@ namespace dae
 		Vector3 viewDirection{};
 	};
 
+	// Up to SIMD_WIDTH rasterized pixels waiting to be shaded together
+	struct PixelBatch
+	{
+		int pixelIndices[SIMD_WIDTH]{};
+		Vector2 uv[SIMD_WIDTH]{};
+		Vector3 normal[SIMD_WIDTH]{};
+		Vector3 tangent[SIMD_WIDTH]{};
+		Vector3 viewDirection[SIMD_WIDTH]{};
+		int nrOfPixels{};
+	};
+
 	enum class PrimitiveTopology
 	{
 		TriangleList,
@@ -0,0 +1,109 @@
+#ifndef FASTMATH_H
+#define FASTMATH_H
+
+#include <bit>
+#include <cmath>
+#include <cstdint>
+
+namespace dae
+{
+	/* --- HELPER ENUMS --- */
+	enum class PowPrecision
+	{
+		Exact = 0,	// powf
+		High,		// 5th order polynomials, max abs error ~2e-4
+		Medium,		// 3rd order polynomials, max abs error ~5e-3
+		Low			// 2nd order polynomials, max abs error ~3e-2
+	};
+
+	/* --- HELPER STRUCTS --- */
+	struct PowErrorReport
+	{
+		float maxAbsError;
+		float meanAbsError;
+		float maxRelError;
+	};
+
+	/* --- FAST TRANSCENDENTALS --- */
+	// log2 for x > 0: exponent taken from the float bits, mantissa in [1, 2) through a polynomial
+	inline float FastLog2(float x, PowPrecision precision)
+	{
+		const uint32_t bits{ std::bit_cast<uint32_t>(x) };
+		const float exponent{ static_cast<float>(static_cast<int>(bits >> 23) - 127) };
+		const float t{ std::bit_cast<float>((bits & 0x007FFFFF) | 0x3F800000) - 1.f };
+
+		switch (precision)
+		{
+		case PowPrecision::Low:
+			return exponent + t * (1.34267148f + t * -0.34267148f);
+		case PowPrecision::Medium:
+			return exponent + t * (1.42086454f + t * (-0.57725065f + t * 0.15638611f));
+		case PowPrecision::High:
+		default:
+			return exponent + t * (1.44174030f + t * (-0.70777018f + t * (0.41234422f + t * (-0.19031903f + t * 0.04400469f))));
+		}
+	}
+
+	// 2^x: integer part written straight into the exponent bits, fraction in [0, 1) through a polynomial
+	inline float FastExp2(float x, PowPrecision precision)
+	{
+		if (x < -126.f) x = -126.f;
+		if (x > 127.f) x = 127.f;
+
+		int integer{ static_cast<int>(x) };
+		if (x < static_cast<float>(integer)) --integer;
+		const float f{ x - static_cast<float>(integer) };
+		const float scale{ std::bit_cast<float>(static_cast<uint32_t>(integer + 127) << 23) };
+
+		switch (precision)
+		{
+		case PowPrecision::Low:
+			return scale * (1.f + f * (0.65636586f + f * 0.34363414f));
+		case PowPrecision::Medium:
+			return scale * (1.f + f * (0.69592847f + f * (0.22494631f + f * 0.07912522f)));
+		case PowPrecision::High:
+		default:
+			return scale * (1.f + f * (0.69315359f + f * (0.24014419f + f * (0.05585857f + f * (0.00894844f + f * 0.00189521f)))));
+		}
+	}
+
+	// base^exp for base > 0 (returns 0 otherwise)
+	inline float FastPow(float base, float exp, PowPrecision precision)
+	{
+		if (precision == PowPrecision::Exact) return powf(base, exp);
+		if (base <= 0.f) return 0.f;
+
+		return FastExp2(exp * FastLog2(base, precision), precision);
+	}
+
+	// Compares FastPow against powf over base in (0, 1] and exp in [0, maxExponent]
+	inline PowErrorReport MeasurePowError(PowPrecision precision, float maxExponent, int nrOfSamples = 256)
+	{
+		PowErrorReport report{};
+		double totalAbsError{};
+
+		for (int baseIdx{ 1 }; baseIdx <= nrOfSamples; ++baseIdx)
+		{
+			const float base{ baseIdx / static_cast<float>(nrOfSamples) };
+
+			for (int expIdx{}; expIdx <= nrOfSamples; ++expIdx)
+			{
+				const float exp{ maxExponent * expIdx / static_cast<float>(nrOfSamples) };
+
+				const float exact{ powf(base, exp) };
+				const float absError{ fabsf(FastPow(base, exp, precision) - exact) };
+
+				totalAbsError += absError;
+				if (absError > report.maxAbsError) report.maxAbsError = absError;
+
+				// relative error is meaningless for results that end up black anyway
+				if (exact > 1e-3f && absError / exact > report.maxRelError) report.maxRelError = absError / exact;
+			}
+		}
+
+		report.meanAbsError = static_cast<float>(totalAbsError / (static_cast<double>(nrOfSamples) * (nrOfSamples + 1)));
+		return report;
+	}
+}
+
+#endif // !FASTMATH_H
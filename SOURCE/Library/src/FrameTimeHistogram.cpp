@@ -0,0 +1,128 @@
+//Standard includes
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#include "FrameTimeHistogram.h"
+
+using namespace dae;
+
+void FrameTimeHistogram::Reset()
+{
+	m_Counts.fill(0);
+	m_NextWindowIdx = 0;
+	m_NrOfWindowFrames = 0;
+
+	m_IsLastFrameHitch = false;
+	m_NrOfHitches = 0;
+	m_WorstHitch = 0.f;
+}
+
+void FrameTimeHistogram::AddFrame(float seconds)
+{
+	// compared to the median of the frames before it, so a hitch can't raise its own bar
+	constexpr int nrOfSettleFrames{ 30 };
+	const float median{ GetPercentile(50.f) };
+	m_IsLastFrameHitch = m_NrOfWindowFrames >= nrOfSettleFrames && seconds > HITCH_FACTOR * median;
+	if (m_IsLastFrameHitch)
+	{
+		++m_NrOfHitches;
+		m_WorstHitch = std::max(m_WorstHitch, seconds);
+	}
+
+	// the oldest frame leaves the window once it is full
+	if (m_NrOfWindowFrames == WINDOW_SIZE)
+	{
+		--m_Counts[GetBucket(m_Window[m_NextWindowIdx])];
+	}
+	else
+	{
+		++m_NrOfWindowFrames;
+	}
+
+	m_Window[m_NextWindowIdx] = seconds;
+	++m_Counts[GetBucket(seconds)];
+	m_NextWindowIdx = (m_NextWindowIdx + 1) % WINDOW_SIZE;
+}
+
+float FrameTimeHistogram::GetPercentile(float percentile) const
+{
+	if (m_NrOfWindowFrames == 0) return 0.f;
+
+	// nearest rank
+	const uint32_t rank{ std::max(static_cast<uint32_t>(std::ceil(percentile / 100.f * m_NrOfWindowFrames)), 1u) };
+	uint32_t nrOfFrames{};
+	for (int bucketIdx{}; bucketIdx < NR_OF_BUCKETS; ++bucketIdx)
+	{
+		nrOfFrames += m_Counts[bucketIdx];
+		if (nrOfFrames >= rank) return GetBucketUpperBound(bucketIdx) * 1e-6f;
+	}
+	return MAX_MICROSECONDS * 1e-6f;
+}
+
+float FrameTimeHistogram::GetMax() const
+{
+	// exact, the window still has the frame times themselves
+	return *std::max_element(m_Window.begin(), m_Window.begin() + m_NrOfWindowFrames);
+}
+
+void FrameTimeHistogram::Print() const
+{
+	if (m_NrOfWindowFrames == 0) return;
+
+	std::cout << std::fixed << std::setprecision(2)
+		<< "Frame time over the last " << m_NrOfWindowFrames << " frames (ms): "
+		<< "p50 " << GetPercentile(50.f) * 1000.f
+		<< ", p95 " << GetPercentile(95.f) * 1000.f
+		<< ", p99 " << GetPercentile(99.f) * 1000.f
+		<< ", max " << GetMax() * 1000.f
+		<< " | hitches (> " << HITCH_FACTOR << "x median) " << m_NrOfHitches
+		<< ", worst " << m_WorstHitch * 1000.f << "\n";
+}
+
+bool FrameTimeHistogram::ExportCSV(const std::string& path) const
+{
+	std::ofstream file{ path };
+	if (!file) return false;
+
+	file << std::fixed << std::setprecision(3) << "lowerMs,upperMs,frames\n";
+	for (int bucketIdx{}; bucketIdx < NR_OF_BUCKETS; ++bucketIdx)
+	{
+		if (m_Counts[bucketIdx] == 0) continue;
+		file << GetBucketLowerBound(bucketIdx) * 0.001f << "," << GetBucketUpperBound(bucketIdx) * 0.001f << "," << m_Counts[bucketIdx] << "\n";
+	}
+	return static_cast<bool>(file);
+}
+
+int FrameTimeHistogram::GetBucket(float seconds)
+{
+	// the float clamp can round up to 2^MAX_BITS, hence the second one
+	const float clampedMicroseconds{ std::clamp(seconds * 1e6f, 0.f, static_cast<float>(MAX_MICROSECONDS)) };
+	const uint32_t microseconds{ std::min(static_cast<uint32_t>(clampedMicroseconds), MAX_MICROSECONDS) };
+	if (microseconds < LINEAR_BUCKETS) return static_cast<int>(microseconds);
+
+	// the top 6 bits select the bucket within the power of two, shift says which power of two
+	const int shift{ static_cast<int>(std::bit_width(microseconds)) - 6 };
+	return LINEAR_BUCKETS + (shift - 1) * HALF_BUCKETS + static_cast<int>(microseconds >> shift) - HALF_BUCKETS;
+}
+
+uint32_t FrameTimeHistogram::GetBucketLowerBound(int bucketIdx)
+{
+	if (bucketIdx < LINEAR_BUCKETS) return static_cast<uint32_t>(bucketIdx);
+
+	const int shift{ (bucketIdx - LINEAR_BUCKETS) / HALF_BUCKETS + 1 };
+	const uint32_t subBucket{ static_cast<uint32_t>((bucketIdx - LINEAR_BUCKETS) % HALF_BUCKETS + HALF_BUCKETS) };
+	return subBucket << shift;
+}
+
+uint32_t FrameTimeHistogram::GetBucketUpperBound(int bucketIdx)
+{
+	if (bucketIdx < LINEAR_BUCKETS) return static_cast<uint32_t>(bucketIdx + 1);
+
+	const int shift{ (bucketIdx - LINEAR_BUCKETS) / HALF_BUCKETS + 1 };
+	const uint32_t subBucket{ static_cast<uint32_t>((bucketIdx - LINEAR_BUCKETS) % HALF_BUCKETS + HALF_BUCKETS) };
+	return (subBucket + 1) << shift;
+}
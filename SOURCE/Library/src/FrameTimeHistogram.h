@@ -0,0 +1,66 @@
+#ifndef FRAMETIMEHISTOGRAM_H
+#define FRAMETIMEHISTOGRAM_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+namespace dae
+{
+	// Frame times of the last WINDOW_SIZE frames in fixed log-linear buckets (HdrHistogram style, ~3% precision
+	// from 64 us to a minute), with percentiles and hitch detection. Fixed size, adding a frame never allocates
+	class FrameTimeHistogram final
+	{
+	public:
+		static constexpr int WINDOW_SIZE{ 1024 };
+		static constexpr float HITCH_FACTOR{ 2.f };	// frames this many times the median are hitches
+
+		FrameTimeHistogram() = default;
+		~FrameTimeHistogram() = default;
+
+		FrameTimeHistogram(const FrameTimeHistogram&) = delete;
+		FrameTimeHistogram(FrameTimeHistogram&&) noexcept = delete;
+		FrameTimeHistogram& operator=(const FrameTimeHistogram&) = delete;
+		FrameTimeHistogram& operator=(FrameTimeHistogram&&) noexcept = delete;
+
+		void Reset();
+		void AddFrame(float seconds);
+
+		// in seconds over the window, upper edge of the bucket the percentile falls in; 0 without frames
+		float GetPercentile(float percentile) const;
+		float GetMax() const;
+		int GetNrOfFrames() const { return m_NrOfWindowFrames; };
+
+		// since the last Reset
+		bool IsLastFrameHitch() const { return m_IsLastFrameHitch; };
+		int GetNrOfHitches() const { return m_NrOfHitches; };
+		float GetWorstHitch() const { return m_WorstHitch; };
+
+		void Print() const;
+		// lower ms, upper ms, frames per non-empty bucket; returns false if the file can't be written
+		bool ExportCSV(const std::string& path) const;
+
+	private:
+		// values below LINEAR_BUCKETS us get a bucket each, every power of two above that is split in HALF_BUCKETS
+		static constexpr int LINEAR_BUCKETS{ 64 };
+		static constexpr int HALF_BUCKETS{ LINEAR_BUCKETS / 2 };
+		static constexpr int MAX_BITS{ 26 };	// ~67 s, longer frames land in the last bucket
+		static constexpr uint32_t MAX_MICROSECONDS{ (1u << MAX_BITS) - 1 };
+		static constexpr int NR_OF_BUCKETS{ LINEAR_BUCKETS + (MAX_BITS - 6) * HALF_BUCKETS };
+
+		static int GetBucket(float seconds);
+		static uint32_t GetBucketLowerBound(int bucketIdx);
+		static uint32_t GetBucketUpperBound(int bucketIdx);
+
+		std::array<uint32_t, NR_OF_BUCKETS> m_Counts{};
+		std::array<float, WINDOW_SIZE> m_Window{};	// ring of the frame times that are in m_Counts
+		int m_NextWindowIdx{};
+		int m_NrOfWindowFrames{};
+
+		bool m_IsLastFrameHitch{};
+		int m_NrOfHitches{};
+		float m_WorstHitch{};
+	};
+}
+
+#endif // !FRAMETIMEHISTOGRAM_H
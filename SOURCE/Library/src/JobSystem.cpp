@@ -0,0 +1,352 @@
+//Standard includes
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "JobSystem.h"
+#include "Trace.h"
+
+using namespace dae;
+
+namespace
+{
+	// which worker of which job system the current thread is, -1 for every other thread
+	thread_local const JobSystem* t_pJobSystem{ nullptr };
+	thread_local int t_WorkerIdx{ -1 };
+}
+
+/* --- TASK GRAPH --- */
+int TaskGraph::AddTask(const std::function<void()>& task)
+{
+	if (m_NrOfTasks == static_cast<int>(m_pNodes.size())) m_pNodes.push_back(std::make_unique<Node>());
+
+	Node& node{ *m_pNodes[m_NrOfTasks] };
+	node.function = task;
+	node.continuations.clear();
+	node.nrOfDependencies = 0;
+
+	return m_NrOfTasks++;
+}
+
+void TaskGraph::AddDependency(int task, int dependency)
+{
+	assert(task >= 0 && task < m_NrOfTasks);
+	assert(dependency >= 0 && dependency < m_NrOfTasks);
+
+	m_pNodes[dependency]->continuations.push_back(task);
+	++m_pNodes[task]->nrOfDependencies;
+}
+
+void TaskGraph::Clear()
+{
+	m_NrOfTasks = 0;
+}
+
+/* --- WORK QUEUE --- */
+bool JobSystem::WorkQueue::Push(const Task& task)
+{
+	const int64_t bottom{ m_Bottom.load(std::memory_order_relaxed) };
+	const int64_t top{ m_Top.load(std::memory_order_acquire) };
+
+	// top only grows, a stale one can make the deque look fuller than it is but never less full
+	if (bottom - top >= CAPACITY) return false;
+
+	Write(bottom, task);
+	m_Bottom.store(bottom + 1, std::memory_order_release);
+	return true;
+}
+
+bool JobSystem::WorkQueue::Pop(Task& task)
+{
+	const int64_t bottom{ m_Bottom.load(std::memory_order_relaxed) - 1 };
+	m_Bottom.store(bottom, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t top{ m_Top.load(std::memory_order_relaxed) };
+
+	if (top > bottom)
+	{
+		// empty
+		m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+		return false;
+	}
+
+	task = Read(bottom);
+	if (top == bottom)
+	{
+		// last task, race the thieves for it
+		const bool isWon{ m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed) };
+		m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+		return isWon;
+	}
+	return true;
+}
+
+bool JobSystem::WorkQueue::Steal(Task& task)
+{
+	int64_t top{ m_Top.load(std::memory_order_acquire) };
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	const int64_t bottom{ m_Bottom.load(std::memory_order_acquire) };
+
+	if (top >= bottom) return false;
+
+	task = Read(top);
+	return m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+}
+
+void JobSystem::WorkQueue::Write(int64_t position, const Task& task)
+{
+	Slot& slot{ m_Slots[position & (CAPACITY - 1)] };
+	slot.pFunction.store(task.pFunction, std::memory_order_relaxed);
+	slot.pData.store(task.pData, std::memory_order_relaxed);
+	slot.index.store(task.index, std::memory_order_relaxed);
+}
+
+JobSystem::Task JobSystem::WorkQueue::Read(int64_t position) const
+{
+	const Slot& slot{ m_Slots[position & (CAPACITY - 1)] };
+	return { slot.pFunction.load(std::memory_order_relaxed), slot.pData.load(std::memory_order_relaxed), slot.index.load(std::memory_order_relaxed) };
+}
+
+/* --- JOB SYSTEM --- */
+JobSystem::JobSystem(int nrOfWorkers, bool pinWorkers)
+	: m_PinWorkers{ pinWorkers }
+{
+	if (nrOfWorkers < 0)
+	{
+		const int nrOfHardwareThreads{ static_cast<int>(std::thread::hardware_concurrency()) };
+		nrOfWorkers = nrOfHardwareThreads > 1 ? nrOfHardwareThreads - 1 : 0;
+	}
+
+	// set before any worker starts, they read it while the others are still being created
+	m_NrOfWorkers = nrOfWorkers;
+	m_pWorkQueues = std::make_unique<WorkQueue[]>(nrOfWorkers);
+
+	m_Workers.reserve(nrOfWorkers);
+	for (int workerIdx{}; workerIdx < nrOfWorkers; ++workerIdx)
+	{
+		m_Workers.emplace_back(&JobSystem::WorkerLoop, this, workerIdx);
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		const std::lock_guard lock{ m_IdleMutex };
+		m_IsRunning = false;
+	}
+	m_TaskScheduled.notify_all();
+
+	for (std::thread& worker : m_Workers)
+	{
+		worker.join();
+	}
+}
+
+void JobSystem::Run(TaskGraph& graph)
+{
+	if (graph.m_NrOfTasks == 0) return;
+
+	graph.m_NrOfUnfinishedTasks.store(graph.m_NrOfTasks, std::memory_order_relaxed);
+	for (int taskIdx{}; taskIdx < graph.m_NrOfTasks; ++taskIdx)
+	{
+		TaskGraph::Node& node{ *graph.m_pNodes[taskIdx] };
+		node.nrOfPendingDependencies.store(node.nrOfDependencies, std::memory_order_relaxed);
+	}
+
+	// roots first, the rest gets scheduled by whatever finishes their last dependency
+	for (int taskIdx{}; taskIdx < graph.m_NrOfTasks; ++taskIdx)
+	{
+		if (graph.m_pNodes[taskIdx]->nrOfDependencies == 0) Schedule({ &JobSystem::ExecuteGraphTask, &graph, taskIdx });
+	}
+
+	WaitUntil(graph.m_NrOfUnfinishedTasks);
+}
+
+void JobSystem::ParallelFor(int first, int last, int grainSize, const std::function<void(int, int)>& function)
+{
+	if (first >= last) return;
+	assert(grainSize > 0);
+
+	const int nrOfChunks{ (last - first + grainSize - 1) / grainSize };
+	if (nrOfChunks == 1 || m_NrOfWorkers == 0)
+	{
+		function(first, last);
+		return;
+	}
+
+	LoopData loop{ &function, first, last, grainSize, {} };
+	loop.nrOfUnfinishedChunks.store(nrOfChunks, std::memory_order_relaxed);
+
+	for (int chunkIdx{}; chunkIdx < nrOfChunks; ++chunkIdx)
+	{
+		Schedule({ &JobSystem::ExecuteLoopChunk, &loop, chunkIdx });
+	}
+
+	WaitUntil(loop.nrOfUnfinishedChunks);
+}
+
+void JobSystem::ExecuteGraphTask(JobSystem& jobSystem, void* pData, int index)
+{
+	TaskGraph& graph{ *static_cast<TaskGraph*>(pData) };
+	TaskGraph::Node& node{ *graph.m_pNodes[index] };
+
+	node.function();
+
+	for (const int continuation : node.continuations)
+	{
+		TaskGraph::Node& next{ *graph.m_pNodes[continuation] };
+		if (next.nrOfPendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			jobSystem.Schedule({ &JobSystem::ExecuteGraphTask, &graph, continuation });
+		}
+	}
+
+	graph.m_NrOfUnfinishedTasks.fetch_sub(1, std::memory_order_release);
+}
+
+void JobSystem::ExecuteLoopChunk(JobSystem&, void* pData, int index)
+{
+	LoopData& loop{ *static_cast<LoopData*>(pData) };
+
+	const int chunkFirst{ loop.first + index * loop.grainSize };
+	const int chunkLast{ std::min(chunkFirst + loop.grainSize, loop.last) };
+	(*loop.pFunction)(chunkFirst, chunkLast);
+
+	loop.nrOfUnfinishedChunks.fetch_sub(1, std::memory_order_release);
+}
+
+void JobSystem::Schedule(const Task& task)
+{
+	if (m_NrOfWorkers == 0)
+	{
+		task.pFunction(*this, task.pData, task.index);
+		return;
+	}
+
+	// a full deque spills into the shared queue, a task graph can release more continuations at once than fit
+	if (t_pJobSystem != this || !m_pWorkQueues[t_WorkerIdx].Push(task))
+	{
+		const std::lock_guard lock{ m_SharedMutex };
+		m_SharedTasks.push_back(task);
+	}
+
+	m_NrOfQueuedTasks.fetch_add(1, std::memory_order_release);
+	m_TaskScheduled.notify_one();
+}
+
+bool JobSystem::FindTask(Task& task)
+{
+	const int nrOfWorkers{ m_NrOfWorkers };
+	const int ownIdx{ t_pJobSystem == this ? t_WorkerIdx : -1 };
+
+	// own deque, newest first
+	bool isFound{ ownIdx >= 0 && m_pWorkQueues[ownIdx].Pop(task) };
+
+	// tasks handed in from outside, oldest first
+	if (!isFound && m_NrOfQueuedTasks.load(std::memory_order_acquire) > 0)
+	{
+		const std::lock_guard lock{ m_SharedMutex };
+		if (m_FirstSharedTask < m_SharedTasks.size())
+		{
+			task = m_SharedTasks[m_FirstSharedTask++];
+			if (m_FirstSharedTask == m_SharedTasks.size())
+			{
+				m_SharedTasks.clear();
+				m_FirstSharedTask = 0;
+			}
+			isFound = true;
+		}
+	}
+
+	// steal the oldest task of another worker, starting next to ourselves so thieves spread out
+	for (int offset{ 1 }; !isFound && offset <= nrOfWorkers; ++offset)
+	{
+		const int victimIdx{ (ownIdx + offset + nrOfWorkers) % nrOfWorkers };
+		if (victimIdx == ownIdx) continue;
+		isFound = m_pWorkQueues[victimIdx].Steal(task);
+	}
+
+	if (isFound) m_NrOfQueuedTasks.fetch_sub(1, std::memory_order_relaxed);
+	return isFound;
+}
+
+void JobSystem::WaitUntil(const std::atomic<int>& nrOfUnfinished)
+{
+	// help out instead of blocking, whatever gets picked up brings the wait closer to its end
+	Task task{};
+	while (nrOfUnfinished.load(std::memory_order_acquire) > 0)
+	{
+		if (FindTask(task))
+		{
+			task.pFunction(*this, task.pData, task.index);
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+void JobSystem::WorkerLoop(int workerIdx)
+{
+	t_pJobSystem = this;
+	t_WorkerIdx = workerIdx;
+	Trace::SetThreadName(("Worker " + std::to_string(workerIdx)).c_str());
+
+	if (m_PinWorkers) PinCurrentThread(workerIdx + 1); // core 0 is left to the thread that owns the job system
+
+	constexpr int nrOfSpins{ 64 };
+	Task task{};
+	int nrOfFailedSearches{};
+
+	while (m_IsRunning.load(std::memory_order_acquire))
+	{
+		if (FindTask(task))
+		{
+			task.pFunction(*this, task.pData, task.index);
+			nrOfFailedSearches = 0;
+			continue;
+		}
+
+		if (++nrOfFailedSearches < nrOfSpins)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		// the timeout covers a notify that slips in between the check and the wait
+		std::unique_lock lock{ m_IdleMutex };
+		m_TaskScheduled.wait_for(lock, std::chrono::milliseconds{ 1 }, [this]
+			{
+				return m_NrOfQueuedTasks.load(std::memory_order_acquire) > 0 || !m_IsRunning.load(std::memory_order_acquire);
+			});
+		nrOfFailedSearches = 0;
+	}
+}
+
+void JobSystem::PinCurrentThread(int core) const
+{
+	const int nrOfCores{ static_cast<int>(std::thread::hardware_concurrency()) };
+	if (nrOfCores <= 0) return;
+	core %= nrOfCores;
+
+#if defined(_WIN32)
+	SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR{ 1 } << core);
+#elif defined(__linux__)
+	cpu_set_t cpuSet;
+	CPU_ZERO(&cpuSet);
+	CPU_SET(core, &cpuSet);
+	pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+#else
+	(void)core;
+#endif
+}
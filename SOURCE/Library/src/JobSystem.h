@@ -0,0 +1,155 @@
+#ifndef JOBSYSTEM_H
+#define JOBSYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dae
+{
+	class JobSystem;
+
+	// Tasks plus "runs after" edges, built by the caller and executed with JobSystem::Run.
+	// Clear keeps every allocation, so a graph rebuilt each frame stops allocating after the first one
+	class TaskGraph final
+	{
+	public:
+		TaskGraph() = default;
+		~TaskGraph() = default;
+
+		TaskGraph(const TaskGraph&) = delete;
+		TaskGraph(TaskGraph&&) noexcept = delete;
+		TaskGraph& operator=(const TaskGraph&) = delete;
+		TaskGraph& operator=(TaskGraph&&) noexcept = delete;
+
+		// returns the index to use in AddDependency
+		int AddTask(const std::function<void()>& task);
+		// task only starts once dependency has finished
+		void AddDependency(int task, int dependency);
+		void Clear();
+
+		int GetNrOfTasks() const { return m_NrOfTasks; };
+
+	private:
+		friend class JobSystem;
+
+		struct Node
+		{
+			std::function<void()> function;
+			std::vector<int> continuations;
+			int nrOfDependencies;
+			std::atomic<int> nrOfPendingDependencies;
+		};
+
+		std::vector<std::unique_ptr<Node>> m_pNodes;
+		int m_NrOfTasks{};
+		std::atomic<int> m_NrOfUnfinishedTasks{};
+	};
+
+	// Work-stealing scheduler: every worker owns a deque it pushes and pops at the bottom,
+	// idle workers steal from the top of the others without taking a lock.
+	// Threads that are not workers (main, frame workers, render contexts) hand their tasks in through a shared queue
+	// and help executing while they wait
+	class JobSystem final
+	{
+	public:
+		// nrOfWorkers < 0 -> one per hardware thread besides the caller, 0 -> everything runs on the calling thread
+		explicit JobSystem(int nrOfWorkers = -1, bool pinWorkers = false);
+		~JobSystem();
+
+		JobSystem(const JobSystem&) = delete;
+		JobSystem(JobSystem&&) noexcept = delete;
+		JobSystem& operator=(const JobSystem&) = delete;
+		JobSystem& operator=(JobSystem&&) noexcept = delete;
+
+		// blocks until every task of the graph has finished
+		void Run(TaskGraph& graph);
+		// function(first, last) over [first, last) in chunks of grainSize, blocks until done
+		void ParallelFor(int first, int last, int grainSize, const std::function<void(int, int)>& function);
+
+		int GetNrOfWorkers() const { return m_NrOfWorkers; };
+		bool ArePinned() const { return m_PinWorkers; };
+
+		// tasks a worker's deque holds, a worker scheduling more than that spills them to the shared queue
+		static constexpr int QUEUE_CAPACITY{ 1 << 13 };
+
+	private:
+		struct Task
+		{
+			void (*pFunction)(JobSystem& jobSystem, void* pData, int index);
+			void* pData;
+			int index;
+		};
+
+		// Chase-Lev deque, fixed capacity
+		class WorkQueue final
+		{
+		public:
+			// returns false without pushing when the deque is full
+			bool Push(const Task& task);
+			bool Pop(Task& task);
+			bool Steal(Task& task);
+
+		private:
+			static constexpr int64_t CAPACITY{ QUEUE_CAPACITY };
+			static_assert((CAPACITY & (CAPACITY - 1)) == 0);
+
+			// a thief reads a slot before its CAS on top decides whether it owns it, while the owner may already be
+			// reusing it; relaxed atomics make that read race-free, m_Bottom's release/acquire publishes the writes
+			struct Slot
+			{
+				std::atomic<void (*)(JobSystem& jobSystem, void* pData, int index)> pFunction;
+				std::atomic<void*> pData;
+				std::atomic<int> index;
+			};
+
+			void Write(int64_t position, const Task& task);
+			Task Read(int64_t position) const;
+
+			alignas(64) std::atomic<int64_t> m_Top{};
+			alignas(64) std::atomic<int64_t> m_Bottom{};
+			Slot m_Slots[CAPACITY]{};
+		};
+
+		struct LoopData
+		{
+			const std::function<void(int, int)>* pFunction;
+			int first;
+			int last;
+			int grainSize;
+			std::atomic<int> nrOfUnfinishedChunks;
+		};
+
+		static void ExecuteGraphTask(JobSystem& jobSystem, void* pData, int index);
+		static void ExecuteLoopChunk(JobSystem& jobSystem, void* pData, int index);
+
+		void Schedule(const Task& task);
+		bool FindTask(Task& task);
+		void WaitUntil(const std::atomic<int>& nrOfUnfinished);
+		void WorkerLoop(int workerIdx);
+		void PinCurrentThread(int core) const;
+
+		std::vector<std::thread> m_Workers;
+		int m_NrOfWorkers;
+		std::unique_ptr<WorkQueue[]> m_pWorkQueues;
+		bool m_PinWorkers;
+
+		// tasks scheduled from threads that are not workers, and the ones that don't fit in a worker's deque
+		std::mutex m_SharedMutex;
+		std::vector<Task> m_SharedTasks;
+		size_t m_FirstSharedTask{};
+
+		// idle workers sleep until something gets scheduled
+		std::atomic<int> m_NrOfQueuedTasks{};
+		std::mutex m_IdleMutex;
+		std::condition_variable m_TaskScheduled;
+		std::atomic<bool> m_IsRunning{ true };
+	};
+}
+
+#endif // !JOBSYSTEM_H
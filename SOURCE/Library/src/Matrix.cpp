@@ -284,6 +284,29 @@ namespace dae {
 		};
 	}
 
+	Matrix Matrix::CreatePerspectiveFovLHReversedZ(float fov, float aspectRatio, float near, float far)
+	{
+		// same as CreatePerspectiveFovLH, but near maps to 1 and far to 0
+		// A = -near / (far - near)
+		// B = (far * near) / (far - near)
+
+		// float spends most of its precision close to 0, which now lands on the far distances
+		// instead of being wasted on the few units in front of near
+
+		const float divFOV{ 1.f / fov };
+		const float divAspectFOV{ 1.f / aspectRatio * divFOV };
+		const float A{ -near / (far - near) };
+		const float B{ (far * near) / (far - near) };
+
+		return
+		{
+			{	divAspectFOV	, 0.f		, 0.f	, 0.f },
+			{	0.f				, divFOV	, 0.f	, 0.f },
+			{	0.f				, 0.f		, A		, 1.f },
+			{	0.f				, 0.f		, B		, 0.f }
+		};
+	}
+
 #pragma region Operator Overloads
 	Vector4& Matrix::operator[](int index)
 	{
@@ -54,6 +54,7 @@ namespace dae
 
 		static Matrix CreateLookAtLH(const Vector3& origin, const Vector3& forward, const Vector3& up);
 		static Matrix CreatePerspectiveFovLH(float fov, float aspect, float zn, float zf);
+		static Matrix CreatePerspectiveFovLHReversedZ(float fov, float aspect, float zn, float zf);
 
 		Vector4& operator[](int index);
 		Vector4 operator[](int index) const;
@@ -0,0 +1,253 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <immintrin.h>
+
+#include "ColorRGB.h"
+#include "FastMath.h"
+#include "Vector3.h"
+
+namespace dae
+{
+	// Lanes per bundle, SSE2 is the baseline for both x64 and Win32 targets
+	constexpr int SIMD_WIDTH{ 4 };
+
+	/* --- SoA BUNDLES --- */
+	struct Vector3x4
+	{
+		__m128 x;
+		__m128 y;
+		__m128 z;
+
+		Vector3x4() = default;
+		Vector3x4(__m128 _x, __m128 _y, __m128 _z)
+			: x{ _x }, y{ _y }, z{ _z }
+		{
+		}
+
+		explicit Vector3x4(const Vector3& v)
+			: x{ _mm_set1_ps(v.x) }, y{ _mm_set1_ps(v.y) }, z{ _mm_set1_ps(v.z) }
+		{
+		}
+
+		Vector3x4 Normalized() const
+		{
+			const __m128 invM{ _mm_div_ps(_mm_set1_ps(1.f), _mm_sqrt_ps(Dot(*this, *this))) };
+			return *this * invM;
+		}
+
+		// transposes SIMD_WIDTH consecutive Vector3s into one bundle
+		static Vector3x4 FromArray(const Vector3* v)
+		{
+			return
+			{
+				_mm_setr_ps(v[0].x, v[1].x, v[2].x, v[3].x),
+				_mm_setr_ps(v[0].y, v[1].y, v[2].y, v[3].y),
+				_mm_setr_ps(v[0].z, v[1].z, v[2].z, v[3].z)
+			};
+		}
+
+		static __m128 Dot(const Vector3x4& v1, const Vector3x4& v2)
+		{
+			return _mm_add_ps(_mm_add_ps(_mm_mul_ps(v1.x, v2.x), _mm_mul_ps(v1.y, v2.y)), _mm_mul_ps(v1.z, v2.z));
+		}
+
+		static Vector3x4 Cross(const Vector3x4& v1, const Vector3x4& v2)
+		{
+			return
+			{
+				_mm_sub_ps(_mm_mul_ps(v1.y, v2.z), _mm_mul_ps(v1.z, v2.y)),
+				_mm_sub_ps(_mm_mul_ps(v1.z, v2.x), _mm_mul_ps(v1.x, v2.z)),
+				_mm_sub_ps(_mm_mul_ps(v1.x, v2.y), _mm_mul_ps(v1.y, v2.x))
+			};
+		}
+
+		static Vector3x4 Reflect(const Vector3x4& v1, const Vector3x4& v2)
+		{
+			return v1 - v2 * _mm_mul_ps(_mm_set1_ps(2.f), Dot(v1, v2));
+		}
+
+		Vector3x4 operator*(__m128 scale) const
+		{
+			return { _mm_mul_ps(x, scale), _mm_mul_ps(y, scale), _mm_mul_ps(z, scale) };
+		}
+
+		Vector3x4 operator+(const Vector3x4& v) const
+		{
+			return { _mm_add_ps(x, v.x), _mm_add_ps(y, v.y), _mm_add_ps(z, v.z) };
+		}
+
+		Vector3x4 operator-(const Vector3x4& v) const
+		{
+			return { _mm_sub_ps(x, v.x), _mm_sub_ps(y, v.y), _mm_sub_ps(z, v.z) };
+		}
+
+		Vector3x4 operator-() const
+		{
+			const __m128 zero{ _mm_setzero_ps() };
+			return { _mm_sub_ps(zero, x), _mm_sub_ps(zero, y), _mm_sub_ps(zero, z) };
+		}
+	};
+
+	struct ColorRGBx4
+	{
+		__m128 r;
+		__m128 g;
+		__m128 b;
+
+		ColorRGBx4() = default;
+		ColorRGBx4(__m128 _r, __m128 _g, __m128 _b)
+			: r{ _r }, g{ _g }, b{ _b }
+		{
+		}
+
+		explicit ColorRGBx4(__m128 colorValue)
+			: r{ colorValue }, g{ colorValue }, b{ colorValue }
+		{
+		}
+
+		explicit ColorRGBx4(const ColorRGB& c)
+			: r{ _mm_set1_ps(c.r) }, g{ _mm_set1_ps(c.g) }, b{ _mm_set1_ps(c.b) }
+		{
+		}
+
+		static ColorRGBx4 FromArray(const ColorRGB* c)
+		{
+			return
+			{
+				_mm_setr_ps(c[0].r, c[1].r, c[2].r, c[3].r),
+				_mm_setr_ps(c[0].g, c[1].g, c[2].g, c[3].g),
+				_mm_setr_ps(c[0].b, c[1].b, c[2].b, c[3].b)
+			};
+		}
+
+		void ToArray(ColorRGB* c) const
+		{
+			alignas(16) float rs[SIMD_WIDTH];
+			alignas(16) float gs[SIMD_WIDTH];
+			alignas(16) float bs[SIMD_WIDTH];
+			_mm_store_ps(rs, r);
+			_mm_store_ps(gs, g);
+			_mm_store_ps(bs, b);
+
+			for (int lane{}; lane < SIMD_WIDTH; ++lane)
+			{
+				c[lane] = { rs[lane], gs[lane], bs[lane] };
+			}
+		}
+
+		// keeps lhs where mask is clear, rhs where it is set
+		static ColorRGBx4 Select(const ColorRGBx4& lhs, const ColorRGBx4& rhs, __m128 mask)
+		{
+			return
+			{
+				_mm_or_ps(_mm_andnot_ps(mask, lhs.r), _mm_and_ps(mask, rhs.r)),
+				_mm_or_ps(_mm_andnot_ps(mask, lhs.g), _mm_and_ps(mask, rhs.g)),
+				_mm_or_ps(_mm_andnot_ps(mask, lhs.b), _mm_and_ps(mask, rhs.b))
+			};
+		}
+
+		ColorRGBx4 operator+(const ColorRGBx4& c) const
+		{
+			return { _mm_add_ps(r, c.r), _mm_add_ps(g, c.g), _mm_add_ps(b, c.b) };
+		}
+
+		ColorRGBx4 operator*(const ColorRGBx4& c) const
+		{
+			return { _mm_mul_ps(r, c.r), _mm_mul_ps(g, c.g), _mm_mul_ps(b, c.b) };
+		}
+
+		ColorRGBx4 operator*(__m128 s) const
+		{
+			return { _mm_mul_ps(r, s), _mm_mul_ps(g, s), _mm_mul_ps(b, s) };
+		}
+	};
+
+	/* --- FAST TRANSCENDENTALS --- */
+	// Lane-wise versions of FastLog2/FastExp2/FastPow, same polynomials as FastMath.h
+	inline __m128 FastLog2(__m128 x, PowPrecision precision)
+	{
+		const __m128i bits{ _mm_castps_si128(x) };
+		const __m128 exponent{ _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127))) };
+		const __m128 mantissa{ _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007FFFFF)), _mm_set1_epi32(0x3F800000))) };
+		const __m128 t{ _mm_sub_ps(mantissa, _mm_set1_ps(1.f)) };
+
+		__m128 poly{};
+		switch (precision)
+		{
+		case PowPrecision::Low:
+			poly = _mm_add_ps(_mm_set1_ps(1.34267148f), _mm_mul_ps(t, _mm_set1_ps(-0.34267148f)));
+			break;
+		case PowPrecision::Medium:
+			poly = _mm_add_ps(_mm_set1_ps(-0.57725065f), _mm_mul_ps(t, _mm_set1_ps(0.15638611f)));
+			poly = _mm_add_ps(_mm_set1_ps(1.42086454f), _mm_mul_ps(t, poly));
+			break;
+		case PowPrecision::High:
+		default:
+			poly = _mm_add_ps(_mm_set1_ps(-0.19031903f), _mm_mul_ps(t, _mm_set1_ps(0.04400469f)));
+			poly = _mm_add_ps(_mm_set1_ps(0.41234422f), _mm_mul_ps(t, poly));
+			poly = _mm_add_ps(_mm_set1_ps(-0.70777018f), _mm_mul_ps(t, poly));
+			poly = _mm_add_ps(_mm_set1_ps(1.44174030f), _mm_mul_ps(t, poly));
+			break;
+		}
+
+		return _mm_add_ps(exponent, _mm_mul_ps(t, poly));
+	}
+
+	inline __m128 FastExp2(__m128 x, PowPrecision precision)
+	{
+		x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-126.f)), _mm_set1_ps(127.f));
+
+		// floor without SSE4.1: truncate, then step down where truncation rounded up
+		__m128i integer{ _mm_cvttps_epi32(x) };
+		const __m128 roundedUp{ _mm_cmpgt_ps(_mm_cvtepi32_ps(integer), x) };
+		integer = _mm_sub_epi32(integer, _mm_and_si128(_mm_castps_si128(roundedUp), _mm_set1_epi32(1)));
+
+		const __m128 f{ _mm_sub_ps(x, _mm_cvtepi32_ps(integer)) };
+		const __m128 scale{ _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(integer, _mm_set1_epi32(127)), 23)) };
+
+		__m128 poly{};
+		switch (precision)
+		{
+		case PowPrecision::Low:
+			poly = _mm_add_ps(_mm_set1_ps(0.65636586f), _mm_mul_ps(f, _mm_set1_ps(0.34363414f)));
+			break;
+		case PowPrecision::Medium:
+			poly = _mm_add_ps(_mm_set1_ps(0.22494631f), _mm_mul_ps(f, _mm_set1_ps(0.07912522f)));
+			poly = _mm_add_ps(_mm_set1_ps(0.69592847f), _mm_mul_ps(f, poly));
+			break;
+		case PowPrecision::High:
+		default:
+			poly = _mm_add_ps(_mm_set1_ps(0.00894844f), _mm_mul_ps(f, _mm_set1_ps(0.00189521f)));
+			poly = _mm_add_ps(_mm_set1_ps(0.05585857f), _mm_mul_ps(f, poly));
+			poly = _mm_add_ps(_mm_set1_ps(0.24014419f), _mm_mul_ps(f, poly));
+			poly = _mm_add_ps(_mm_set1_ps(0.69315359f), _mm_mul_ps(f, poly));
+			break;
+		}
+
+		return _mm_mul_ps(scale, _mm_add_ps(_mm_set1_ps(1.f), _mm_mul_ps(f, poly)));
+	}
+
+	// base^exp for base > 0 (returns 0 otherwise), Exact evaluates powf per lane
+	inline __m128 FastPow(__m128 base, __m128 exp, PowPrecision precision)
+	{
+		if (precision == PowPrecision::Exact)
+		{
+			alignas(16) float bases[SIMD_WIDTH];
+			alignas(16) float exps[SIMD_WIDTH];
+			_mm_store_ps(bases, base);
+			_mm_store_ps(exps, exp);
+
+			for (int lane{}; lane < SIMD_WIDTH; ++lane)
+			{
+				bases[lane] = bases[lane] > 0.f ? powf(bases[lane], exps[lane]) : 0.f;
+			}
+			return _mm_load_ps(bases);
+		}
+
+		const __m128 positive{ _mm_cmpgt_ps(base, _mm_setzero_ps()) };
+		return _mm_and_ps(positive, FastExp2(_mm_mul_ps(exp, FastLog2(base, precision)), precision));
+	}
+}
+
+#endif // !SIMD_H
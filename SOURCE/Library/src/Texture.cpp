@@ -40,4 +40,9 @@ namespace dae
 		SDL_GetRGB(m_pSurfacePixels[index], m_pSurface->format, &color.r, &color.g, &color.b);
 		return color;
 	}
+
+	size_t Texture::GetSizeInBytes() const
+	{
+		return static_cast<size_t>(m_pSurface->pitch) * m_pSurface->h;
+	}
 }
\ No newline at end of file
@@ -14,6 +14,7 @@ namespace dae
 
 		static Texture* LoadFromFile(const std::string& path);
 		const ColorRGB Sample(const Vector2& uv) const;
+		size_t GetSizeInBytes() const;
 
 	private:
 		Texture(SDL_Surface* pSurface);
@@ -22,6 +22,7 @@ void Timer::Reset()
 	m_FPSTimer = 0.0f;
 	m_FPSCount = 0;
 	m_IsStopped = false;
+	m_FrameTimeHistogram.Reset();
 }
 
 void Timer::Start()
@@ -56,6 +57,8 @@ void Timer::Update()
 	if (m_ElapsedTime < 0.0f)
 		m_ElapsedTime = 0.0f;
 
+	m_FrameTimeHistogram.AddFrame(m_ElapsedTime);
+
 	if (m_ForceElapsedUpperBound && m_ElapsedTime > m_ElapsedUpperBound)
 	{
 		m_ElapsedTime = m_ElapsedUpperBound;
@@ -2,6 +2,8 @@
 #ifndef TIMER_H
 #define TIMER_H
 
+#include "FrameTimeHistogram.h"
+
 namespace dae
 {
 	class Timer
@@ -25,6 +27,8 @@ namespace dae
 		float GetElapsed() const { return m_ElapsedTime; };
 		float GetTotal() const { return m_TotalTime; };
 		bool IsRunning() const { return !m_IsStopped; };
+		// unclamped frame times of the recent frames
+		const FrameTimeHistogram& GetFrameTimeHistogram() const { return m_FrameTimeHistogram; };
 
 	private:
 		uint64_t m_BaseTime = 0;
@@ -45,6 +49,8 @@ namespace dae
 
 		bool m_IsStopped = true;
 		bool m_ForceElapsedUpperBound = false;
+
+		FrameTimeHistogram m_FrameTimeHistogram{};
 	};
 }
 
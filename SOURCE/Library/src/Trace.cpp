@@ -0,0 +1,172 @@
+//Standard includes
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Trace.h"
+#include "Utils.h"
+
+using namespace dae;
+
+namespace
+{
+	struct Event
+	{
+		const char* pName;
+		int64_t start;	// ns since the capture began
+		int64_t end;
+		int argument;
+	};
+
+	// events per thread, a capture keeps the newest RING_CAPACITY of them (2 MB per thread)
+	constexpr uint64_t RING_CAPACITY{ 1 << 16 };
+	constexpr int MAX_NAME_LENGTH{ 32 };
+
+	struct ThreadBuffer
+	{
+		char name[MAX_NAME_LENGTH];
+		int threadId;
+		std::unique_ptr<Event[]> pEvents;
+
+		// only the owning thread writes these; events of an earlier capture get dropped by the owner itself,
+		// the first time it records in a capture with a newer generation
+		std::atomic<uint32_t> generation;
+		std::atomic<uint64_t> nrOfEvents; // written events of that generation, published after the event itself
+	};
+
+	// steady clock ns, zones of an earlier capture may still read it while the next one begins
+	std::atomic<int64_t> g_CaptureStart{};
+	// bumped by every BeginCapture, 0 is never a capture
+	std::atomic<uint32_t> g_CaptureGeneration{};
+
+	int64_t GetSteadyNanoseconds()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	// every thread that recorded in any capture, kept after it exits so its events can still be written
+	std::mutex g_RegistryMutex;
+	std::vector<std::unique_ptr<ThreadBuffer>> g_ThreadBuffers;
+
+	thread_local ThreadBuffer* t_pThreadBuffer{ nullptr };
+	thread_local char t_ThreadName[MAX_NAME_LENGTH]{};
+
+	ThreadBuffer& GetThreadBuffer()
+	{
+		if (t_pThreadBuffer) return *t_pThreadBuffer;
+
+		const std::lock_guard lock{ g_RegistryMutex };
+		std::unique_ptr<ThreadBuffer> pThreadBuffer{ std::make_unique<ThreadBuffer>() };
+		pThreadBuffer->threadId = static_cast<int>(g_ThreadBuffers.size());
+		pThreadBuffer->pEvents = std::make_unique<Event[]>(RING_CAPACITY);
+		if (t_ThreadName[0])
+		{
+			std::memcpy(pThreadBuffer->name, t_ThreadName, MAX_NAME_LENGTH);
+		}
+		else
+		{
+			const std::string name{ "Thread " + std::to_string(pThreadBuffer->threadId) };
+			std::strncpy(pThreadBuffer->name, name.c_str(), MAX_NAME_LENGTH - 1);
+		}
+
+		t_pThreadBuffer = pThreadBuffer.get();
+		g_ThreadBuffers.push_back(std::move(pThreadBuffer));
+		return *t_pThreadBuffer;
+	}
+}
+
+std::atomic<bool> Trace::Detail::g_IsCapturing{ false };
+
+int64_t Trace::Detail::GetTimestamp()
+{
+	return GetSteadyNanoseconds() - g_CaptureStart.load(std::memory_order_relaxed);
+}
+
+void Trace::Detail::RecordZone(const char* pName, int64_t start, int64_t end, int argument)
+{
+	ThreadBuffer& threadBuffer{ GetThreadBuffer() };
+
+	const uint32_t generation{ g_CaptureGeneration.load(std::memory_order_relaxed) };
+	if (threadBuffer.generation.load(std::memory_order_relaxed) != generation)
+	{
+		// the reset is published by the generation, a reader that sees the new one also sees the empty ring
+		threadBuffer.nrOfEvents.store(0, std::memory_order_relaxed);
+		threadBuffer.generation.store(generation, std::memory_order_release);
+	}
+
+	const uint64_t eventIdx{ threadBuffer.nrOfEvents.load(std::memory_order_relaxed) };
+
+	threadBuffer.pEvents[eventIdx % RING_CAPACITY] = { pName, start, end, argument };
+	threadBuffer.nrOfEvents.store(eventIdx + 1, std::memory_order_release);
+}
+
+void Trace::SetThreadName(const char* pName)
+{
+	std::strncpy(t_ThreadName, pName, MAX_NAME_LENGTH - 1);
+	if (t_pThreadBuffer) std::memcpy(t_pThreadBuffer->name, t_ThreadName, MAX_NAME_LENGTH);
+}
+
+void Trace::BeginCapture()
+{
+	g_CaptureGeneration.fetch_add(1, std::memory_order_relaxed);
+	g_CaptureStart.store(GetSteadyNanoseconds(), std::memory_order_relaxed);
+	Detail::g_IsCapturing.store(true, std::memory_order_release);
+}
+
+void Trace::EndCapture()
+{
+	Detail::g_IsCapturing.store(false, std::memory_order_release);
+}
+
+bool Trace::IsCapturing()
+{
+	return Detail::g_IsCapturing.load(std::memory_order_acquire);
+}
+
+bool Trace::WriteCapture(const std::string& path)
+{
+	std::ofstream file{ path };
+	if (!file) return false;
+	file << std::fixed << std::setprecision(3);
+
+	// "X" complete events with microsecond timestamps, plus the thread names as metadata
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"Rasterizer\"}}";
+
+	const uint32_t generation{ g_CaptureGeneration.load(std::memory_order_relaxed) };
+	const std::lock_guard lock{ g_RegistryMutex };
+	for (const std::unique_ptr<ThreadBuffer>& pThreadBuffer : g_ThreadBuffers)
+	{
+		// a thread that hasn't recorded since BeginCapture still holds an earlier capture
+		if (pThreadBuffer->generation.load(std::memory_order_acquire) != generation) continue;
+
+		const uint64_t nrOfEvents{ pThreadBuffer->nrOfEvents.load(std::memory_order_acquire) };
+		if (nrOfEvents == 0) continue;
+
+		file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << pThreadBuffer->threadId << ",\"args\":{\"name\":\"";
+		Utils::WriteEscaped(file, pThreadBuffer->name);
+		file << "\"}}";
+
+		// oldest first, a full ring only has the newest RING_CAPACITY
+		for (uint64_t eventIdx{ nrOfEvents - std::min(nrOfEvents, RING_CAPACITY) }; eventIdx < nrOfEvents; ++eventIdx)
+		{
+			const Event& event{ pThreadBuffer->pEvents[eventIdx % RING_CAPACITY] };
+			file << ",\n{\"name\":\"";
+			// names are literals in practice, this only keeps the JSON valid if one isn't
+			Utils::WriteEscaped(file, event.pName);
+			file << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << pThreadBuffer->threadId
+				<< ",\"ts\":" << event.start * 0.001
+				<< ",\"dur\":" << (event.end - event.start) * 0.001;
+			if (event.argument >= 0) file << ",\"args\":{\"index\":" << event.argument << "}";
+			file << "}";
+		}
+	}
+
+	file << "\n]}\n";
+	return static_cast<bool>(file);
+}
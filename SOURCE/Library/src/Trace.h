@@ -0,0 +1,65 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace dae
+{
+	// Timeline capture in the Chrome trace event format (chrome://tracing, ui.perfetto.dev).
+	// Zones go into a fixed ring buffer per thread that only its own thread writes, no locks on the recording path;
+	// outside a capture a zone costs one atomic load
+	namespace Trace
+	{
+		namespace Detail
+		{
+			extern std::atomic<bool> g_IsCapturing;
+			int64_t GetTimestamp();
+			void RecordZone(const char* pName, int64_t start, int64_t end, int argument);
+		}
+
+		// one complete event from construction to destruction on the calling thread
+		// pName has to outlive the capture (string literals), argument shows up as "index" when >= 0
+		class Zone final
+		{
+		public:
+			explicit Zone(const char* pName, int argument = -1)
+				: m_pName{ pName },
+				m_Argument{ argument },
+				m_IsRecording{ Detail::g_IsCapturing.load(std::memory_order_acquire) }
+			{
+				if (m_IsRecording) m_Start = Detail::GetTimestamp();
+			}
+			~Zone()
+			{
+				if (m_IsRecording) Detail::RecordZone(m_pName, m_Start, Detail::GetTimestamp(), m_Argument);
+			}
+
+			Zone(const Zone&) = delete;
+			Zone(Zone&&) noexcept = delete;
+			Zone& operator=(const Zone&) = delete;
+			Zone& operator=(Zone&&) noexcept = delete;
+
+		private:
+			const char* m_pName;
+			int m_Argument;
+			bool m_IsRecording;
+			int64_t m_Start{};
+		};
+
+		// track name of the calling thread in the capture, copied
+		void SetThreadName(const char* pName);
+
+		// drops whatever an earlier capture recorded, every thread clears its own ring the next time it records
+		void BeginCapture();
+		void EndCapture();
+		bool IsCapturing();
+
+		// after EndCapture, once every thread is done with the frames that were captured;
+		// returns false if the file can't be written
+		bool WriteCapture(const std::string& path);
+	}
+}
+
+#endif // !TRACE_H
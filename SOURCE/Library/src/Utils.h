@@ -4,6 +4,7 @@
 
 #include <cassert>
 #include <fstream>
+#include <ostream>
 
 #include "Maths.h"
 #include "DataTypes.h"
@@ -175,6 +176,24 @@ namespace dae
 			return true;
 #endif
 		}
+
+		//Contents of a JSON string: quotes and backslashes escaped, control characters as \u00XX
+		static void WriteEscaped(std::ostream& out, const char* pText)
+		{
+			constexpr const char* hexDigits{ "0123456789abcdef" };
+			for (; *pText; ++pText)
+			{
+				const unsigned char character{ static_cast<unsigned char>(*pText) };
+				if (character < 0x20)
+				{
+					out << "\\u00" << hexDigits[character >> 4] << hexDigits[character & 0xF];
+					continue;
+				}
+
+				if (character == '"' || character == '\\') out << '\\';
+				out << *pText;
+			}
+		}
 #pragma warning(pop)
 	}
 }
@@ -0,0 +1,279 @@
+//Standard includes
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+
+//Project includes
+#include "AllocationTracker.h"
+
+using namespace dae;
+
+namespace
+{
+	constexpr int NR_OF_STAGES{ static_cast<int>(Allocations::Stage::Count) };
+}
+
+#ifdef ENABLE_ALLOCATION_TRACKING
+namespace
+{
+	// a fixed table, registering a thread can't allocate from inside operator new;
+	// threads past MAX_THREADS share the last block, which only costs contention
+	constexpr int MAX_THREADS{ 256 };
+
+	struct alignas(64) ThreadCounts
+	{
+		std::atomic<uint64_t> nrOfAllocations[NR_OF_STAGES];
+		std::atomic<uint64_t> nrOfBytes[NR_OF_STAGES];
+		std::atomic<uint64_t> nrOfDeallocations[NR_OF_STAGES];
+	};
+
+	ThreadCounts g_ThreadCounts[MAX_THREADS]{};
+	std::atomic<int> g_NrOfThreads{};
+
+	// constant initialized, reading them never runs a thread_local constructor
+	thread_local ThreadCounts* t_pThreadCounts{ nullptr };
+	thread_local Allocations::Stage t_Stage{ Allocations::Stage::Other };
+
+	ThreadCounts& GetThreadCounts()
+	{
+		if (!t_pThreadCounts)
+		{
+			const int threadIdx{ g_NrOfThreads.fetch_add(1, std::memory_order_relaxed) };
+			t_pThreadCounts = &g_ThreadCounts[threadIdx < MAX_THREADS ? threadIdx : MAX_THREADS - 1];
+		}
+		return *t_pThreadCounts;
+	}
+
+	void CountAllocation(size_t size)
+	{
+		ThreadCounts& threadCounts{ GetThreadCounts() };
+		const int stageIdx{ static_cast<int>(t_Stage) };
+		threadCounts.nrOfAllocations[stageIdx].fetch_add(1, std::memory_order_relaxed);
+		threadCounts.nrOfBytes[stageIdx].fetch_add(size, std::memory_order_relaxed);
+	}
+
+	void CountDeallocation()
+	{
+		GetThreadCounts().nrOfDeallocations[static_cast<int>(t_Stage)].fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void* Allocate(size_t size) noexcept
+	{
+		CountAllocation(size);
+		return std::malloc(size ? size : 1);
+	}
+
+	void* AllocateAligned(size_t size, std::align_val_t alignment) noexcept
+	{
+		CountAllocation(size);
+		const size_t alignmentBytes{ static_cast<size_t>(alignment) };
+#ifdef _WIN32
+		return _aligned_malloc(size ? size : 1, alignmentBytes);
+#else
+		// aligned_alloc wants a non-zero multiple of the alignment
+		const size_t alignedSize{ size ? (size + alignmentBytes - 1) / alignmentBytes * alignmentBytes : alignmentBytes };
+		return std::aligned_alloc(alignmentBytes, alignedSize);
+#endif
+	}
+
+	void Deallocate(void* pMemory) noexcept
+	{
+		if (!pMemory) return;
+		CountDeallocation();
+		std::free(pMemory);
+	}
+
+	void DeallocateAligned(void* pMemory) noexcept
+	{
+		if (!pMemory) return;
+		CountDeallocation();
+#ifdef _WIN32
+		_aligned_free(pMemory);
+#else
+		std::free(pMemory);
+#endif
+	}
+}
+
+/* --- GLOBAL OPERATOR NEW / DELETE --- */
+
+void* operator new(size_t size)
+{
+	void* pMemory{ Allocate(size) };
+	if (!pMemory) throw std::bad_alloc{};
+	return pMemory;
+}
+
+void* operator new[](size_t size)
+{
+	void* pMemory{ Allocate(size) };
+	if (!pMemory) throw std::bad_alloc{};
+	return pMemory;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	return Allocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	return Allocate(size);
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+	void* pMemory{ AllocateAligned(size, alignment) };
+	if (!pMemory) throw std::bad_alloc{};
+	return pMemory;
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+	void* pMemory{ AllocateAligned(size, alignment) };
+	if (!pMemory) throw std::bad_alloc{};
+	return pMemory;
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return AllocateAligned(size, alignment);
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return AllocateAligned(size, alignment);
+}
+
+void operator delete(void* pMemory) noexcept
+{
+	Deallocate(pMemory);
+}
+
+void operator delete[](void* pMemory) noexcept
+{
+	Deallocate(pMemory);
+}
+
+void operator delete(void* pMemory, size_t) noexcept
+{
+	Deallocate(pMemory);
+}
+
+void operator delete[](void* pMemory, size_t) noexcept
+{
+	Deallocate(pMemory);
+}
+
+void operator delete(void* pMemory, const std::nothrow_t&) noexcept
+{
+	Deallocate(pMemory);
+}
+
+void operator delete[](void* pMemory, const std::nothrow_t&) noexcept
+{
+	Deallocate(pMemory);
+}
+
+void operator delete(void* pMemory, std::align_val_t) noexcept
+{
+	DeallocateAligned(pMemory);
+}
+
+void operator delete[](void* pMemory, std::align_val_t) noexcept
+{
+	DeallocateAligned(pMemory);
+}
+
+void operator delete(void* pMemory, size_t, std::align_val_t) noexcept
+{
+	DeallocateAligned(pMemory);
+}
+
+void operator delete[](void* pMemory, size_t, std::align_val_t) noexcept
+{
+	DeallocateAligned(pMemory);
+}
+
+void operator delete(void* pMemory, std::align_val_t, const std::nothrow_t&) noexcept
+{
+	DeallocateAligned(pMemory);
+}
+
+void operator delete[](void* pMemory, std::align_val_t, const std::nothrow_t&) noexcept
+{
+	DeallocateAligned(pMemory);
+}
+
+/* --- ALLOCATIONS --- */
+
+Allocations::Scope::Scope(Stage stage)
+	: m_PreviousStage{ t_Stage }
+{
+	t_Stage = stage;
+}
+
+Allocations::Scope::~Scope()
+{
+	t_Stage = m_PreviousStage;
+}
+#else
+/* --- ALLOCATIONS --- */
+
+Allocations::Scope::Scope(Stage)
+{
+}
+
+Allocations::Scope::~Scope()
+{
+}
+#endif
+
+void Allocations::Collect(Counts (&stageCounts)[static_cast<int>(Stage::Count)])
+{
+	for (Counts& counts : stageCounts)
+	{
+		counts = {};
+	}
+
+#ifdef ENABLE_ALLOCATION_TRACKING
+	const int nrOfThreads{ std::min(g_NrOfThreads.load(std::memory_order_relaxed), MAX_THREADS) };
+	for (int threadIdx{}; threadIdx < nrOfThreads; ++threadIdx)
+	{
+		ThreadCounts& threadCounts{ g_ThreadCounts[threadIdx] };
+		for (int stageIdx{}; stageIdx < NR_OF_STAGES; ++stageIdx)
+		{
+			stageCounts[stageIdx].nrOfAllocations += threadCounts.nrOfAllocations[stageIdx].exchange(0, std::memory_order_relaxed);
+			stageCounts[stageIdx].nrOfBytes += threadCounts.nrOfBytes[stageIdx].exchange(0, std::memory_order_relaxed);
+			stageCounts[stageIdx].nrOfDeallocations += threadCounts.nrOfDeallocations[stageIdx].exchange(0, std::memory_order_relaxed);
+		}
+	}
+#endif
+}
+
+void Allocations::Print(const Counts (&stageCounts)[static_cast<int>(Stage::Count)], int nrOfFrames)
+{
+	constexpr const char* stageNames[NR_OF_STAGES]{ "other", "update", "clear", "vertex", "binning", "raster", "resolve", "present" };
+	const double divisor{ nrOfFrames > 0 ? static_cast<double>(nrOfFrames) : 1.0 };
+
+	std::cout << std::fixed << std::setprecision(1)
+		<< "Heap allocations" << (nrOfFrames > 0 ? " per frame (" + std::to_string(nrOfFrames) + " frames)" : "") << "\n";
+
+	bool hasAllocated{ false };
+	for (int stageIdx{}; stageIdx < NR_OF_STAGES; ++stageIdx)
+	{
+		const Counts& counts{ stageCounts[stageIdx] };
+		if (counts.nrOfAllocations == 0 && counts.nrOfDeallocations == 0) continue;
+
+		hasAllocated = true;
+		std::cout << "  " << std::left << std::setw(10) << stageNames[stageIdx] << std::right
+			<< counts.nrOfAllocations / divisor << " allocations, "
+			<< counts.nrOfBytes / divisor << " bytes, "
+			<< counts.nrOfDeallocations / divisor << " frees\n";
+	}
+	if (!hasAllocated) std::cout << "  none\n";
+}
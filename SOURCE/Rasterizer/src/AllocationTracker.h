@@ -0,0 +1,72 @@
+#ifndef ALLOCATIONTRACKER_H
+#define ALLOCATIONTRACKER_H
+
+#include <cstdint>
+
+// replaces the global operator new and delete to count allocations, needed by --check-alloc; compiled out unless
+// defined here or by the build. VLD hooks the same allocations, leave it off in debug builds that use VLD.
+// The Profile|x64 configuration defines it and ENABLE_PIPELINE_STATS without VLD, from the command line:
+//   msbuild GP1_Rasterizer.sln /p:Configuration=Profile /p:Platform=x64
+//   bin\x64\Profile\Rasterizer.exe --check-alloc
+//#define ENABLE_ALLOCATION_TRACKING
+
+namespace dae
+{
+	// Every operator new and delete of the program is counted, attributed to the stage the allocating thread is in.
+	// Per-thread counters, an allocation costs one thread_local lookup and a few uncontended atomic adds.
+	// Without ENABLE_ALLOCATION_TRACKING the scopes do nothing and every count stays 0
+	namespace Allocations
+	{
+#ifdef ENABLE_ALLOCATION_TRACKING
+		constexpr bool IS_ENABLED{ true };
+#else
+		constexpr bool IS_ENABLED{ false };
+#endif
+
+		enum class Stage
+		{
+			Other = 0,	// outside any stage scope, setup, the job system, the main loop
+			Update,
+			Clear,
+			Vertex,
+			Binning,
+			Raster,
+			Resolve,
+			Present,
+			Count
+		};
+
+		struct Counts
+		{
+			uint64_t nrOfAllocations;
+			uint64_t nrOfBytes;			// requested by the allocations
+			uint64_t nrOfDeallocations;
+		};
+
+		// allocations of the calling thread between construction and destruction go to stage, scopes nest
+		class Scope final
+		{
+		public:
+			explicit Scope(Stage stage);
+			~Scope();
+
+			Scope(const Scope&) = delete;
+			Scope(Scope&&) noexcept = delete;
+			Scope& operator=(const Scope&) = delete;
+			Scope& operator=(Scope&&) noexcept = delete;
+
+#ifdef ENABLE_ALLOCATION_TRACKING
+		private:
+			const Stage m_PreviousStage;
+#endif
+		};
+
+		// sums and resets the counts of every thread, indexed by Stage
+		void Collect(Counts (&stageCounts)[static_cast<int>(Stage::Count)]);
+
+		// per stage that allocated, per frame when nrOfFrames > 0
+		void Print(const Counts (&stageCounts)[static_cast<int>(Stage::Count)], int nrOfFrames);
+	}
+}
+
+#endif // !ALLOCATIONTRACKER_H
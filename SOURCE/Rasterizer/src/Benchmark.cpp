@@ -0,0 +1,865 @@
+//Standard includes
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <vector>
+
+//External includes
+#include "SDL.h"
+
+//Project includes
+#include "AllocationTracker.h"
+#include "Benchmark.h"
+#include "CameraPath.h"
+#include "CommandLine.h"
+#include "JobSystem.h"
+#include "Maths.h"
+#include "PerfCounters.h"
+#include "PipelineStats.h"
+#include "Trace.h"
+#include "Renderer.h"
+#include "Scene.h"
+#include "Timer.h"
+#include "Utils.h"
+
+using namespace dae;
+
+namespace
+{
+	struct Resolution
+	{
+		int width;
+		int height;
+	};
+
+	// average ms per Update + Render over nrOfFrames, after a short warm-up
+	double MeasureFrameTime(Renderer& renderer, Timer& timer, int nrOfFrames)
+	{
+		constexpr int nrOfWarmUpFrames{ 5 };
+		for (int frame{}; frame < nrOfWarmUpFrames; ++frame)
+		{
+			renderer.Update(&timer);
+			renderer.Render();
+			timer.Update();
+		}
+
+		const auto start{ std::chrono::steady_clock::now() };
+		for (int frame{}; frame < nrOfFrames; ++frame)
+		{
+			renderer.Update(&timer);
+			renderer.Render();
+			timer.Update();
+		}
+		renderer.WaitForFrame();
+		const std::chrono::duration<double, std::milli> elapsed{ std::chrono::steady_clock::now() - start };
+
+		return elapsed.count() / nrOfFrames;
+	}
+
+	// results of the math benchmark end up here so the compiler can't drop the work; every component of every
+	// result has to be summed into it, a result that gets overwritten or a component that is never read can be optimized out
+	volatile float g_MathSink{};
+
+	float SumOfComponents(const Matrix& matrix)
+	{
+		const Vector4 rowSum{ matrix[0] + matrix[1] + matrix[2] + matrix[3] };
+		return rowSum.x + rowSum.y + rowSum.z + rowSum.w;
+	}
+
+	// best ns per operation of a few runs, operation processes nrOfOperations inputs per call
+	template<typename Operation>
+	double MeasureNanosecondsPerOperation(int nrOfOperations, const Operation& operation)
+	{
+		constexpr int nrOfRuns{ 5 };
+		operation(); // warm up caches and branch predictors
+
+		double bestTime{ std::numeric_limits<double>::max() };
+		for (int run{}; run < nrOfRuns; ++run)
+		{
+			const auto start{ std::chrono::steady_clock::now() };
+			operation();
+			const std::chrono::duration<double, std::nano> elapsed{ std::chrono::steady_clock::now() - start };
+			bestTime = std::min(bestTime, elapsed.count());
+		}
+		return bestTime / nrOfOperations;
+	}
+
+	// nearest rank, sortedValues ascending and not empty
+	double Percentile(const std::vector<double>& sortedValues, double percentile)
+	{
+		const size_t rank{ static_cast<size_t>(std::ceil(percentile / 100.0 * sortedValues.size())) };
+		return sortedValues[std::clamp(rank, size_t{ 1 }, sortedValues.size()) - 1];
+	}
+
+	// {"mean": .., "median": .., "p95": .., "p99": .., "min": .., "max": ..} of values
+	void WriteStatistics(std::ostream& out, std::vector<double> values)
+	{
+		std::sort(values.begin(), values.end());
+		const double mean{ std::accumulate(values.begin(), values.end(), 0.0) / values.size() };
+
+		out << "{ \"mean\": " << mean
+			<< ", \"median\": " << Percentile(values, 50.0)
+			<< ", \"p95\": " << Percentile(values, 95.0)
+			<< ", \"p99\": " << Percentile(values, 99.0)
+			<< ", \"min\": " << values.front()
+			<< ", \"max\": " << values.back() << " }";
+	}
+
+	// FNV-1a over the visible pixels
+	uint64_t HashPixels(const uint32_t* pPixels, int nrOfPixels)
+	{
+		uint64_t hash{ 14695981039346656037ull };
+		for (int pixelIdx{}; pixelIdx < nrOfPixels; ++pixelIdx)
+		{
+			hash ^= pPixels[pixelIdx] & 0x00FFFFFF;
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	// "1,4,16" -> { 1, 4, 16 }, false on anything that isn't a number
+	bool ParseList(const std::string& text, std::vector<int>& values)
+	{
+		values.clear();
+		std::istringstream stream{ text };
+		std::string value{};
+		while (std::getline(stream, value, ','))
+		{
+			int parsedValue{};
+			if (!CommandLine::ParseValue(value, parsedValue)) return false;
+			values.push_back(parsedValue);
+		}
+		return !values.empty();
+	}
+
+	// sanity caps of the sweep, past them a combination only runs for ages or out of memory
+	constexpr int MAX_SWEEP_HEIGHT{ 4320 };		// 8K
+	constexpr int MAX_SWEEP_INSTANCES{ 64 };
+	constexpr int MAX_SWEEP_WORKERS{ 256 };
+
+	// 16:9, rounded
+	int GetSweepWidth(int height)
+	{
+		return (height * 16 + 8) / 9;
+	}
+
+	void PrintSweepUsage()
+	{
+		std::cout
+			<< "--sweep [options]\n"
+			<< "  --resolutions LIST heights of 16:9 resolutions (480,720,1080,1440,2160,4320), at most " << MAX_SWEEP_HEIGHT << "\n"
+			<< "  --instances LIST   vehicle instances (1,4,16), at most " << MAX_SWEEP_INSTANCES << "\n"
+			<< "  --workers LIST     job system workers, 0 single threaded, -1 the default (0,-1), at most " << MAX_SWEEP_WORKERS << "\n"
+			<< "  --frames N         measured frames per combination (20)\n"
+			<< "  --warmup N         frames rendered before measuring (3)\n"
+			<< "  --mesh FILE        .obj mesh of every instance (Resources/vehicle.obj)\n"
+			<< "  --diffuse FILE, --normal FILE, --gloss FILE, --specular FILE\n"
+			<< "  --csv FILE         output (sweep.csv)\n"
+			<< "  --pin              pin the workers to cores\n";
+	}
+
+	// null after printing why when a file is missing or the mesh has nothing to render, a benchmark of an empty
+	// scene would report timings of nothing
+	Scene* LoadScene(const SceneFiles& files, JobSystem* pJobSystem, int nrOfInstances = 1)
+	{
+		if (!files.CanOpen()) return nullptr;
+
+		Scene* pScene{ new Scene{ files, pJobSystem, nrOfInstances } };
+		if (pScene->GetMesh().indices.empty())
+		{
+			std::cout << files.mesh << " has no triangles\n";
+			delete pScene;
+			return nullptr;
+		}
+		return pScene;
+	}
+
+	void PrintFrameBenchmarkUsage()
+	{
+		std::cout
+			<< "--bench [options], --check-alloc [options]\n"
+			<< "  --frames N         measured frames (240)\n"
+			<< "  --warmup N         frames rendered before measuring (10)\n"
+			<< "  --size W H         resolution (1280 720)\n"
+			<< "  --mesh FILE        .obj mesh (Resources/vehicle.obj)\n"
+			<< "  --diffuse FILE, --normal FILE, --gloss FILE, --specular FILE\n"
+			<< "  --timestep S       seconds of camera path per frame (0.016667)\n"
+			<< "  --path FILE        camera path, see CameraPath::LoadFromFile (built-in 8 second loop)\n"
+			<< "  --json FILE        write the report to FILE instead of stdout\n"
+			<< "  --trace FILE       Chrome trace of the measured frames\n"
+			<< "  --perf             hardware counters per stage (Linux perf_event_open)\n"
+			<< "  --threads N, --pin job system workers\n";
+	}
+}
+
+void Benchmark::RunClearBenchmark(int nrOfFrames)
+{
+	constexpr Resolution resolutions[]
+	{
+		{ 640, 480 },
+		{ 1280, 720 },
+		{ 1920, 1080 },
+		{ 2560, 1440 },
+		{ 3840, 2160 }
+	};
+
+	std::cout << "Clear benchmark, " << nrOfFrames << " frames per run\n";
+	std::cout << std::setw(12) << "resolution" << std::setw(16) << "full ms/frame" << std::setw(16) << "tiles ms/frame" << std::setw(10) << "speedup" << "\n";
+
+	for (const Resolution& resolution : resolutions)
+	{
+		SDL_Window* pWindow{ SDL_CreateWindow("Rasterizer - Benchmark", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, resolution.width, resolution.height, SDL_WINDOW_HIDDEN) };
+		if (!pWindow) continue;
+
+		Timer* pTimer{ new Timer{} };
+		Renderer* pRenderer{ new Renderer{ pWindow, resolution.width, resolution.height } };
+		pTimer->Start();
+
+		// renderer starts out with the lazy clear enabled
+		const double lazyFrameTime{ MeasureFrameTime(*pRenderer, *pTimer, nrOfFrames) };
+		pRenderer->ToggleLazyClear();
+		const double fullFrameTime{ MeasureFrameTime(*pRenderer, *pTimer, nrOfFrames) };
+
+		std::cout << std::fixed << std::setprecision(3)
+			<< std::setw(12) << (std::to_string(resolution.width) + "x" + std::to_string(resolution.height))
+			<< std::setw(16) << fullFrameTime
+			<< std::setw(16) << lazyFrameTime
+			<< std::setw(9) << fullFrameTime / lazyFrameTime << "x\n";
+
+		pTimer->Stop();
+		delete pRenderer;
+		delete pTimer;
+		SDL_DestroyWindow(pWindow);
+	}
+}
+
+void Benchmark::RunDepthFormatBenchmark(int nrOfFrames)
+{
+	constexpr Resolution resolution{ 1920, 1080 };
+	constexpr float viewDistances[]{ 10.f, 64.f, 250.f, 900.f };
+
+	struct FormatInfo
+	{
+		DepthFormat format;
+		const char* name;
+	};
+	constexpr FormatInfo formats[]
+	{
+		{ DepthFormat::Float32, "Float32" },
+		{ DepthFormat::ReversedFloat32, "ReversedFloat32" },
+		{ DepthFormat::Unorm24, "Unorm24" },
+		{ DepthFormat::Unorm16, "Unorm16" }
+	};
+
+	SDL_Window* pWindow{ SDL_CreateWindow("Rasterizer - Benchmark", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, resolution.width, resolution.height, SDL_WINDOW_HIDDEN) };
+	if (!pWindow) return;
+
+	Timer* pTimer{ new Timer{} };
+	Renderer* pRenderer{ new Renderer{ pWindow, resolution.width, resolution.height } };
+	pTimer->Start();
+
+	std::cout << "Depth format benchmark, " << resolution.width << "x" << resolution.height << ", " << nrOfFrames << " frames per run\n";
+	std::cout << "resolution = smallest view space distance that still changes the stored depth\n";
+	std::cout << std::setw(16) << "format" << std::setw(8) << "B/px" << std::setw(12) << "buffer KB" << std::setw(12) << "ms/frame";
+	for (const float viewDistance : viewDistances)
+	{
+		std::cout << std::setw(14) << ("res@" + std::to_string(static_cast<int>(viewDistance)));
+	}
+	std::cout << "\n";
+
+	for (const FormatInfo& formatInfo : formats)
+	{
+		pRenderer->SetDepthFormat(formatInfo.format);
+		const double frameTime{ MeasureFrameTime(*pRenderer, *pTimer, nrOfFrames) };
+		const int bytesPerPixel{ pRenderer->GetDepthBytesPerPixel() };
+
+		std::cout << std::setw(16) << formatInfo.name
+			<< std::setw(8) << bytesPerPixel
+			<< std::setw(12) << resolution.width * resolution.height * bytesPerPixel / 1024
+			<< std::fixed << std::setprecision(3) << std::setw(12) << frameTime
+			<< std::scientific << std::setprecision(2);
+		for (const float viewDistance : viewDistances)
+		{
+			std::cout << std::setw(14) << pRenderer->GetDepthResolution(viewDistance);
+		}
+		std::cout << std::defaultfloat << "\n";
+	}
+
+	pTimer->Stop();
+	delete pRenderer;
+	delete pTimer;
+	SDL_DestroyWindow(pWindow);
+}
+
+void Benchmark::RunMathBenchmark(int nrOfOperations)
+{
+	// fixed seed, every run gets the same inputs
+	std::mt19937 generator{ 42 };
+	std::uniform_real_distribution<float> distribution{ -10.f, 10.f };
+	const auto random{ [&]() { return distribution(generator); } };
+
+	std::vector<Matrix> matrices(nrOfOperations);
+	std::vector<Vector3> vectors(nrOfOperations);
+	std::vector<Vector3> normals(nrOfOperations);
+	std::vector<ColorRGB> colors(nrOfOperations);
+	for (int idx{}; idx < nrOfOperations; ++idx)
+	{
+		// rotation and translation like the world and view matrices, always invertible
+		matrices[idx] = Matrix::CreateRotation(random(), random(), random()) * Matrix::CreateTranslation(random(), random(), random());
+		vectors[idx] = { random(), random(), random() };
+		normals[idx] = Vector3{ random(), random(), random() }.Normalized();
+		colors[idx] = { std::abs(random()) * 0.1f, std::abs(random()) * 0.1f, std::abs(random()) * 0.1f };
+	}
+
+	struct MathOperation
+	{
+		const char* name;
+		std::function<void()> operation;
+	};
+	const MathOperation operations[]
+	{
+		{ "Matrix * Matrix", [&]()
+			{
+				float sum{};
+				for (int idx{}; idx < nrOfOperations; ++idx) sum += SumOfComponents(matrices[idx] * matrices[nrOfOperations - 1 - idx]);
+				g_MathSink = sum;
+			} },
+		{ "Matrix::Inverse", [&]()
+			{
+				float sum{};
+				for (const Matrix& matrix : matrices) sum += SumOfComponents(Matrix::Inverse(matrix));
+				g_MathSink = sum;
+			} },
+		{ "Matrix::TransformPoint", [&]()
+			{
+				Vector3 sum{ Vector3::Zero };
+				for (int idx{}; idx < nrOfOperations; ++idx) sum += matrices[idx].TransformPoint(vectors[idx]);
+				g_MathSink = sum.x + sum.y + sum.z;
+			} },
+		{ "Matrix::TransformPoint4", [&]()
+			{
+				Vector4 sum{};
+				for (int idx{}; idx < nrOfOperations; ++idx) sum += matrices[idx].TransformPoint(vectors[idx].ToPoint4());
+				g_MathSink = sum.x + sum.y + sum.z + sum.w;
+			} },
+		{ "Matrix::TransformVector", [&]()
+			{
+				Vector3 sum{ Vector3::Zero };
+				for (int idx{}; idx < nrOfOperations; ++idx) sum += matrices[idx].TransformVector(normals[idx]);
+				g_MathSink = sum.x + sum.y + sum.z;
+			} },
+		{ "Vector3::Normalized", [&]()
+			{
+				Vector3 sum{ Vector3::Zero };
+				for (const Vector3& vector : vectors) sum += vector.Normalized();
+				g_MathSink = sum.x + sum.y + sum.z;
+			} },
+		{ "Vector3::Cross", [&]()
+			{
+				Vector3 sum{ Vector3::Zero };
+				for (int idx{}; idx < nrOfOperations; ++idx) sum += Vector3::Cross(vectors[idx], normals[idx]);
+				g_MathSink = sum.x + sum.y + sum.z;
+			} },
+		{ "Vector3::Reflect", [&]()
+			{
+				Vector3 sum{ Vector3::Zero };
+				for (int idx{}; idx < nrOfOperations; ++idx) sum += Vector3::Reflect(vectors[idx], normals[idx]);
+				g_MathSink = sum.x + sum.y + sum.z;
+			} },
+		{ "ColorRGB multiply-add", [&]()
+			{
+				ColorRGB sum{};
+				for (int idx{}; idx < nrOfOperations; ++idx) sum += colors[idx] * colors[nrOfOperations - 1 - idx] * 0.5f;
+				g_MathSink = sum.r + sum.g + sum.b;
+			} },
+		{ "ColorRGB::MaxToOne", [&]()
+			{
+				ColorRGB sum{};
+				for (ColorRGB color : colors)
+				{
+					color *= 20.f;
+					color.MaxToOne();
+					sum += color;
+				}
+				g_MathSink = sum.r + sum.g + sum.b;
+			} }
+	};
+
+	std::cout << "Math benchmark, " << nrOfOperations << " operations per run\n";
+	std::cout << std::setw(26) << "operation" << std::setw(12) << "ns/op" << std::setw(14) << "Mops/s" << "\n";
+
+	for (const MathOperation& mathOperation : operations)
+	{
+		const double nanoseconds{ MeasureNanosecondsPerOperation(nrOfOperations, mathOperation.operation) };
+
+		std::cout << std::fixed << std::setprecision(3)
+			<< std::setw(26) << mathOperation.name
+			<< std::setw(12) << nanoseconds
+			<< std::setw(14) << 1000.0 / nanoseconds << "\n";
+	}
+}
+
+bool Benchmark::ParseFrameBenchmarkSettings(int argc, char* argv[], FrameBenchmarkSettings& settings)
+{
+	for (int argIdx{ 2 }; argIdx < argc; ++argIdx)
+	{
+		const std::string argument{ argv[argIdx] };
+		const int nrOfValues{ argc - 1 - argIdx };
+
+		bool isValid{ true };
+		if (argument == "--frames" && nrOfValues >= 1) isValid = CommandLine::ParseValue(argv[++argIdx], settings.nrOfFrames);
+		else if (argument == "--warmup" && nrOfValues >= 1) isValid = CommandLine::ParseValue(argv[++argIdx], settings.nrOfWarmUpFrames);
+		else if (argument == "--size" && nrOfValues >= 2)
+		{
+			isValid = CommandLine::ParseValue(argv[++argIdx], settings.width);
+			isValid = CommandLine::ParseValue(argv[++argIdx], settings.height) && isValid;
+		}
+		else if (argument == "--timestep" && nrOfValues >= 1) isValid = CommandLine::ParseValue(argv[++argIdx], settings.timestep);
+		else if (argument == "--mesh" && nrOfValues >= 1) settings.sceneFiles.mesh = argv[++argIdx];
+		else if (argument == "--diffuse" && nrOfValues >= 1) settings.sceneFiles.diffuse = argv[++argIdx];
+		else if (argument == "--normal" && nrOfValues >= 1) settings.sceneFiles.normalMap = argv[++argIdx];
+		else if (argument == "--gloss" && nrOfValues >= 1) settings.sceneFiles.gloss = argv[++argIdx];
+		else if (argument == "--specular" && nrOfValues >= 1) settings.sceneFiles.specular = argv[++argIdx];
+		else if (argument == "--path" && nrOfValues >= 1) settings.cameraPath = argv[++argIdx];
+		else if (argument == "--json" && nrOfValues >= 1) settings.jsonPath = argv[++argIdx];
+		else if (argument == "--trace" && nrOfValues >= 1) settings.tracePath = argv[++argIdx];
+		else if (argument == "--perf") settings.perfCounters = true;
+		else if (argument == "--threads" && nrOfValues >= 1) ++argIdx; // handled by main
+		else if (argument == "--pin") continue;
+		else isValid = false;
+
+		if (!isValid)
+		{
+			std::cout << "Invalid benchmark option: " << argument << "\n";
+			PrintFrameBenchmarkUsage();
+			return false;
+		}
+	}
+
+	if (settings.nrOfFrames <= 0 || settings.nrOfWarmUpFrames < 0 || settings.width <= 0 || settings.height <= 0)
+	{
+		PrintFrameBenchmarkUsage();
+		return false;
+	}
+	return true;
+}
+
+bool Benchmark::RunFrameBenchmark(const FrameBenchmarkSettings& settings, JobSystem* pJobSystem)
+{
+	CameraPath cameraPath{ CameraPath::CreateDefault() };
+	if (!settings.cameraPath.empty() && !cameraPath.LoadFromFile(settings.cameraPath))
+	{
+		std::cout << "Can't load camera path " << settings.cameraPath << "\n";
+		return false;
+	}
+
+	// stderr, stdout may be the report
+	if (settings.perfCounters && !Perf::Enable())
+	{
+		std::cerr << "Hardware counters unavailable (Linux only, see /proc/sys/kernel/perf_event_paranoid)\n";
+	}
+
+	const Scene* pScene{ LoadScene(settings.sceneFiles, pJobSystem) };
+	if (!pScene) return false;
+
+	Timer* pTimer{ new Timer{} };
+	Renderer* pRenderer{ new Renderer{ settings.width, settings.height, nullptr, pJobSystem, pScene } };
+	pTimer->Start();
+
+	Perf::Counts perfCounts[static_cast<int>(Perf::Stage::Count)]{};
+	const int nrOfFrames{ settings.nrOfWarmUpFrames + settings.nrOfFrames };
+	std::vector<double> frameTimes{};
+	std::vector<double> geometryTimes{};
+	std::vector<double> clearTimes{};
+	std::vector<double> rasterTimes{};
+	std::vector<double> resolveTimes{};
+	frameTimes.reserve(settings.nrOfFrames);
+	geometryTimes.reserve(settings.nrOfFrames);
+	clearTimes.reserve(settings.nrOfFrames);
+	rasterTimes.reserve(settings.nrOfFrames);
+	resolveTimes.reserve(settings.nrOfFrames);
+
+	// frames run one at a time, so every stage time belongs to the frame it was measured in
+	for (int frame{}; frame < nrOfFrames; ++frame)
+	{
+		cameraPath.Apply(*pRenderer, frame * settings.timestep);
+		pRenderer->ResetStageTimes();
+		if (frame == settings.nrOfWarmUpFrames)
+		{
+			// pipeline statistics, counters and trace of the measured frames only
+			Stats::Collect();
+			Perf::Collect(perfCounts);
+			if (!settings.tracePath.empty()) Trace::BeginCapture();
+		}
+
+		const auto frameStart{ std::chrono::steady_clock::now() };
+		{
+			const Trace::Zone frameZone{ "Frame", frame };
+			pRenderer->Update(pTimer);
+			pRenderer->Render();
+			pRenderer->WaitForFrame();
+		}
+		const std::chrono::duration<double, std::milli> frameTime{ std::chrono::steady_clock::now() - frameStart };
+		pTimer->Update();
+
+		if (frame < settings.nrOfWarmUpFrames) continue;
+
+		const StageTimes stageTimes{ pRenderer->GetStageTimes() };
+		frameTimes.push_back(frameTime.count());
+		geometryTimes.push_back(stageTimes.geometry * 1000.0);
+		clearTimes.push_back(stageTimes.clear * 1000.0);
+		rasterTimes.push_back(stageTimes.raster * 1000.0);
+		resolveTimes.push_back(stageTimes.resolve * 1000.0);
+	}
+
+	if (Trace::IsCapturing())
+	{
+		Trace::EndCapture();
+		if (!Trace::WriteCapture(settings.tracePath)) std::cout << "Can't write trace " << settings.tracePath << "\n";
+	}
+
+	std::ostringstream report{};
+	report << std::fixed << std::setprecision(4)
+		<< "{\n"
+		<< "  \"benchmark\": \"frame\",\n"
+		<< "  \"width\": " << settings.width << ",\n"
+		<< "  \"height\": " << settings.height << ",\n"
+		<< "  \"frames\": " << settings.nrOfFrames << ",\n"
+		<< "  \"warmupFrames\": " << settings.nrOfWarmUpFrames << ",\n"
+		<< "  \"timestep\": " << settings.timestep << ",\n"
+		<< "  \"cameraPath\": \"";
+	// a Windows path is full of backslashes
+	Utils::WriteEscaped(report, settings.cameraPath.empty() ? "default" : settings.cameraPath.c_str());
+	report << "\",\n"
+		<< "  \"mesh\": \"";
+	Utils::WriteEscaped(report, settings.sceneFiles.mesh.c_str());
+	report << "\",\n"
+		<< "  \"workers\": " << (pJobSystem ? pJobSystem->GetNrOfWorkers() : 0) << ",\n"
+		<< "  \"triangles\": " << pRenderer->GetScene()->GetMesh().indices.size() / 3 << ",\n"
+		<< "  \"lastFrameChecksum\": \"" << std::hex << HashPixels(pRenderer->GetPixels(), settings.width * settings.height) << std::dec << "\",\n"
+		<< "  \"frameTimeMs\": ";
+	WriteStatistics(report, frameTimes);
+	report << ",\n  \"stagesMs\": {\n    \"geometry\": ";
+	WriteStatistics(report, geometryTimes);
+	report << ",\n    \"clear\": ";
+	WriteStatistics(report, clearTimes);
+	report << ",\n    \"raster\": ";
+	WriteStatistics(report, rasterTimes);
+	report << ",\n    \"resolve\": ";
+	WriteStatistics(report, resolveTimes);
+	report << "\n  }";
+
+	// per frame averages, only when the statistics are compiled in
+	if constexpr (Stats::IS_ENABLED)
+	{
+		const PipelineStats stats{ Stats::Collect() };
+		const double nrOfFrames{ static_cast<double>(settings.nrOfFrames) };
+		report
+			<< ",\n  \"pipeline\": {\n"
+			<< "    \"verticesTransformed\": " << stats.verticesTransformed / nrOfFrames << ",\n"
+			<< "    \"trianglesSubmitted\": " << stats.trianglesSubmitted / nrOfFrames << ",\n"
+			<< "    \"trianglesCulled\": " << stats.trianglesCulled / nrOfFrames << ",\n"
+			<< "    \"trianglesClipped\": " << stats.trianglesClipped / nrOfFrames << ",\n"
+			<< "    \"trianglesRasterized\": " << stats.trianglesRasterized / nrOfFrames << ",\n"
+			<< "    \"pixelsTested\": " << stats.pixelsTested / nrOfFrames << ",\n"
+			<< "    \"pixelsDepthPassed\": " << stats.pixelsDepthPassed / nrOfFrames << ",\n"
+			<< "    \"pixelsShaded\": " << stats.pixelsShaded / nrOfFrames << ",\n"
+			<< "    \"overdraw\": " << stats.GetOverdraw(settings.nrOfFrames, settings.width * settings.height) << ",\n"
+			<< "    \"clearMs\": " << stats.clearTime * 1000.0 / nrOfFrames << ",\n"
+			<< "    \"vertexMs\": " << stats.vertexTime * 1000.0 / nrOfFrames << ",\n"
+			<< "    \"rasterMs\": " << stats.rasterTime * 1000.0 / nrOfFrames << ",\n"
+			<< "    \"shadingMs\": " << stats.shadingTime * 1000.0 / nrOfFrames << ",\n"
+			<< "    \"presentMs\": " << stats.presentTime * 1000.0 / nrOfFrames << "\n"
+			<< "  }";
+	}
+	// per frame averages, misses per screen pixel; scaledScopes is the fraction of scopes the kernel multiplexed
+	if (Perf::IsEnabled())
+	{
+		Perf::Collect(perfCounts);
+		Perf::Disable();
+
+		constexpr const char* stageNames[]{ "clear", "vertex", "raster", "resolve" };
+		static_assert(std::size(stageNames) == static_cast<size_t>(Perf::Stage::Count));
+
+		const double nrOfFrames{ static_cast<double>(settings.nrOfFrames) };
+		const double nrOfPixels{ nrOfFrames * settings.width * settings.height };
+		report << ",\n  \"perf\": {";
+		for (int stageIdx{}; stageIdx < static_cast<int>(Perf::Stage::Count); ++stageIdx)
+		{
+			const Perf::Counts& counts{ perfCounts[stageIdx] };
+			report
+				<< (stageIdx ? ",\n" : "\n") << "    \"" << stageNames[stageIdx] << "\": { "
+				<< "\"cycles\": " << counts.cycles / nrOfFrames
+				<< ", \"instructions\": " << counts.instructions / nrOfFrames
+				<< ", \"ipc\": " << (counts.cycles ? static_cast<double>(counts.instructions) / counts.cycles : 0.0)
+				<< ", \"l1dMisses\": " << counts.l1dMisses / nrOfFrames
+				<< ", \"llcMisses\": " << counts.llcMisses / nrOfFrames
+				<< ", \"branchMisses\": " << counts.branchMisses / nrOfFrames
+				<< ", \"l1dMissesPerPixel\": " << counts.l1dMisses / nrOfPixels
+				<< ", \"llcMissesPerPixel\": " << counts.llcMisses / nrOfPixels
+				<< ", \"scaledScopes\": " << (counts.nrOfScopes ? static_cast<double>(counts.nrOfScaledScopes) / counts.nrOfScopes : 0.0) << " }";
+		}
+		report << "\n  }";
+	}
+	report << "\n}\n";
+
+	if (settings.jsonPath.empty())
+	{
+		std::cout << report.str();
+	}
+	else
+	{
+		std::ofstream{ settings.jsonPath } << report.str();
+		std::cout << "Benchmark report written to " << settings.jsonPath << "\n";
+	}
+
+	pTimer->Stop();
+	delete pRenderer;
+	delete pScene;
+	delete pTimer;
+	return true;
+}
+
+bool Benchmark::RunAllocationCheck(const FrameBenchmarkSettings& settings, JobSystem* pJobSystem)
+{
+	if constexpr (!Allocations::IS_ENABLED)
+	{
+		std::cout << "Allocation check unavailable, build the Profile configuration or define ENABLE_ALLOCATION_TRACKING (AllocationTracker.h)\n";
+		return false;
+	}
+
+	CameraPath cameraPath{ CameraPath::CreateDefault() };
+	if (!settings.cameraPath.empty() && !cameraPath.LoadFromFile(settings.cameraPath))
+	{
+		std::cout << "Can't load camera path " << settings.cameraPath << "\n";
+		return false;
+	}
+
+	const Scene* pScene{ LoadScene(settings.sceneFiles, pJobSystem) };
+	if (!pScene) return false;
+
+	Timer* pTimer{ new Timer{} };
+	Renderer* pRenderer{ new Renderer{ settings.width, settings.height, nullptr, pJobSystem, pScene } };
+	pTimer->Start();
+
+	constexpr int nrOfStages{ static_cast<int>(Allocations::Stage::Count) };
+	Allocations::Counts frameCounts[nrOfStages]{};
+	Allocations::Counts steadyCounts[nrOfStages]{};
+	int nrOfAllocatingFrames{};
+	int firstAllocatingFrame{ -1 };
+
+	// setup isn't part of any frame
+	Allocations::Collect(frameCounts);
+
+	const auto renderFrame{ [&](int frame)
+		{
+			cameraPath.Apply(*pRenderer, frame * settings.timestep);
+			pRenderer->Update(pTimer);
+			pRenderer->Render();
+			pRenderer->WaitForFrame();
+			pTimer->Update();
+		} };
+
+	// the warm-up plays the whole camera path, so the bins have grown to whatever the measured frames need
+	const int nrOfWarmUpFrames{ settings.nrOfWarmUpFrames + static_cast<int>(std::ceil(cameraPath.GetDuration() / settings.timestep)) };
+	for (int frame{}; frame < nrOfWarmUpFrames; ++frame)
+	{
+		renderFrame(frame);
+	}
+	Allocations::Collect(frameCounts);
+	std::cout << "Warm-up, " << nrOfWarmUpFrames << " frames\n";
+	Allocations::Print(frameCounts, 0);
+
+	// the measured frames replay the path from the start, nothing in the loop may allocate besides the frame itself
+	for (int frame{}; frame < settings.nrOfFrames; ++frame)
+	{
+		renderFrame(frame);
+
+		Allocations::Collect(frameCounts);
+		bool hasAllocated{ false };
+		for (int stageIdx{}; stageIdx < nrOfStages; ++stageIdx)
+		{
+			hasAllocated |= frameCounts[stageIdx].nrOfAllocations > 0;
+			steadyCounts[stageIdx].nrOfAllocations += frameCounts[stageIdx].nrOfAllocations;
+			steadyCounts[stageIdx].nrOfBytes += frameCounts[stageIdx].nrOfBytes;
+			steadyCounts[stageIdx].nrOfDeallocations += frameCounts[stageIdx].nrOfDeallocations;
+		}
+
+		if (!hasAllocated) continue;
+		if (firstAllocatingFrame < 0) firstAllocatingFrame = frame;
+		++nrOfAllocatingFrames;
+	}
+
+	std::cout << "Steady state, " << settings.nrOfFrames << " frames of " << settings.width << "x" << settings.height
+		<< ", " << (pJobSystem ? pJobSystem->GetNrOfWorkers() : 0) << " workers\n";
+	Allocations::Print(steadyCounts, settings.nrOfFrames);
+
+	if (nrOfAllocatingFrames > 0)
+	{
+		std::cout << "FAILED: " << nrOfAllocatingFrames << " of " << settings.nrOfFrames
+			<< " steady-state frames allocated, the first one is frame " << firstAllocatingFrame << "\n";
+	}
+	else
+	{
+		std::cout << "PASSED: no heap allocations in " << settings.nrOfFrames << " steady-state frames\n";
+	}
+
+	pTimer->Stop();
+	delete pRenderer;
+	delete pScene;
+	delete pTimer;
+	return nrOfAllocatingFrames == 0;
+}
+
+bool Benchmark::ParseSweepSettings(int argc, char* argv[], SweepSettings& settings)
+{
+	for (int argIdx{ 2 }; argIdx < argc; ++argIdx)
+	{
+		const std::string argument{ argv[argIdx] };
+		const int nrOfValues{ argc - 1 - argIdx };
+
+		bool isValid{ true };
+		if (argument == "--resolutions" && nrOfValues >= 1) isValid = ParseList(argv[++argIdx], settings.heights);
+		else if (argument == "--instances" && nrOfValues >= 1) isValid = ParseList(argv[++argIdx], settings.nrOfInstances);
+		else if (argument == "--workers" && nrOfValues >= 1) isValid = ParseList(argv[++argIdx], settings.nrOfWorkers);
+		else if (argument == "--frames" && nrOfValues >= 1) isValid = CommandLine::ParseValue(argv[++argIdx], settings.nrOfFrames);
+		else if (argument == "--warmup" && nrOfValues >= 1) isValid = CommandLine::ParseValue(argv[++argIdx], settings.nrOfWarmUpFrames);
+		else if (argument == "--mesh" && nrOfValues >= 1) settings.sceneFiles.mesh = argv[++argIdx];
+		else if (argument == "--diffuse" && nrOfValues >= 1) settings.sceneFiles.diffuse = argv[++argIdx];
+		else if (argument == "--normal" && nrOfValues >= 1) settings.sceneFiles.normalMap = argv[++argIdx];
+		else if (argument == "--gloss" && nrOfValues >= 1) settings.sceneFiles.gloss = argv[++argIdx];
+		else if (argument == "--specular" && nrOfValues >= 1) settings.sceneFiles.specular = argv[++argIdx];
+		else if (argument == "--csv" && nrOfValues >= 1) settings.csvPath = argv[++argIdx];
+		else if (argument == "--pin") settings.pinWorkers = true;
+		else isValid = false;
+
+		if (!isValid)
+		{
+			std::cout << "Invalid sweep option: " << argument << "\n";
+			PrintSweepUsage();
+			return false;
+		}
+	}
+
+	const auto isValidHeight{ [](int value) { return value > 0 && value <= MAX_SWEEP_HEIGHT; } };
+	const auto isValidNrOfInstances{ [](int value) { return value > 0 && value <= MAX_SWEEP_INSTANCES; } };
+	const auto isValidNrOfWorkers{ [](int value) { return value >= -1 && value <= MAX_SWEEP_WORKERS; } };
+	if (settings.nrOfFrames <= 0 || settings.nrOfWarmUpFrames < 0 ||
+		!std::all_of(settings.heights.begin(), settings.heights.end(), isValidHeight) ||
+		!std::all_of(settings.nrOfInstances.begin(), settings.nrOfInstances.end(), isValidNrOfInstances) ||
+		!std::all_of(settings.nrOfWorkers.begin(), settings.nrOfWorkers.end(), isValidNrOfWorkers))
+	{
+		PrintSweepUsage();
+		return false;
+	}
+
+	// a frame schedules one raster task per bin at once, past the deque capacity they spill to the shared queue
+	// and no longer measure the work-stealing path
+	for (const int height : settings.heights)
+	{
+		const int nrOfBins{ Renderer::GetNrOfBins(GetSweepWidth(height), height) };
+		if (nrOfBins > JobSystem::QUEUE_CAPACITY)
+		{
+			std::cout << "Sweep resolution " << height << "p has " << nrOfBins << " bins, the job system queues " << JobSystem::QUEUE_CAPACITY << "\n";
+			PrintSweepUsage();
+			return false;
+		}
+	}
+	return true;
+}
+
+bool Benchmark::RunSweep(const SweepSettings& settings)
+{
+	// a missing file fails before the CSV gets created and overwrites earlier results
+	if (!settings.sceneFiles.CanOpen()) return false;
+
+	std::ofstream csv{ settings.csvPath };
+	if (!csv)
+	{
+		std::cout << "Can't write " << settings.csvPath << "\n";
+		return false;
+	}
+	csv << std::fixed << std::setprecision(3) << "width,height,instances,triangles,workers,frames,frameMsMean,frameMsMedian,frameMsMin,pixelsPerSecond,trianglesPerSecond\n";
+
+	const size_t nrOfCombinations{ settings.nrOfInstances.size() * settings.nrOfWorkers.size() * settings.heights.size() };
+	std::cout << "Sweep, " << nrOfCombinations << " combinations of " << settings.nrOfFrames << " frames, written to " << settings.csvPath << "\n"
+		<< std::fixed << std::setprecision(2);
+
+	std::vector<double> frameTimes{};
+	frameTimes.reserve(settings.nrOfFrames);
+
+	for (const int nrOfInstances : settings.nrOfInstances)
+	{
+		// one scene per instance count, shared by the renderers of every resolution and worker count
+		const Scene* pScene{ LoadScene(settings.sceneFiles, nullptr, nrOfInstances) };
+		if (!pScene) return false;
+
+		const size_t nrOfTriangles{ pScene->GetMesh().indices.size() / 3 };
+
+		// the instance grid grows with the square root of the count, the camera backs off and rises with it
+		const float gridSize{ std::ceil(std::sqrt(static_cast<float>(nrOfInstances))) };
+		const Vector3 cameraOrigin{ 0.f, 5.f + 20.f * (gridSize - 1.f), -64.f * gridSize };
+		const Vector3 cameraTarget{ 0.f, 5.f / gridSize, 0.f };
+
+		for (const int nrOfWorkers : settings.nrOfWorkers)
+		{
+			JobSystem* pJobSystem{ new JobSystem{ nrOfWorkers, settings.pinWorkers } };
+
+			for (const int height : settings.heights)
+			{
+				const int width{ GetSweepWidth(height) };
+
+				Timer* pTimer{ new Timer{} };
+				Renderer* pRenderer{ new Renderer{ width, height, nullptr, pJobSystem, pScene } };
+				pRenderer->SetCameraLookAt(cameraOrigin, cameraTarget);
+				pRenderer->SetMeshRotation(0.f);
+				pTimer->Start();
+
+				frameTimes.clear();
+				for (int frame{}; frame < settings.nrOfWarmUpFrames + settings.nrOfFrames; ++frame)
+				{
+					const auto frameStart{ std::chrono::steady_clock::now() };
+					pRenderer->Update(pTimer);
+					pRenderer->Render();
+					pRenderer->WaitForFrame();
+					const std::chrono::duration<double, std::milli> frameTime{ std::chrono::steady_clock::now() - frameStart };
+					pTimer->Update();
+
+					if (frame >= settings.nrOfWarmUpFrames) frameTimes.push_back(frameTime.count());
+				}
+
+				std::sort(frameTimes.begin(), frameTimes.end());
+				const double mean{ std::accumulate(frameTimes.begin(), frameTimes.end(), 0.0) / frameTimes.size() };
+				const double pixelsPerSecond{ width * static_cast<double>(height) * 1000.0 / mean };
+				const double trianglesPerSecond{ nrOfTriangles * 1000.0 / mean };
+
+				csv << width << "," << height << "," << nrOfInstances << "," << nrOfTriangles << "," << pJobSystem->GetNrOfWorkers() << ","
+					<< settings.nrOfFrames << "," << mean << "," << Percentile(frameTimes, 50.0) << "," << frameTimes.front() << ","
+					<< pixelsPerSecond << "," << trianglesPerSecond << std::endl;
+
+				std::cout << "  " << std::setw(4) << height << "p, " << std::setw(3) << nrOfInstances << " instances, "
+					<< std::setw(2) << pJobSystem->GetNrOfWorkers() << " workers: " << std::setw(9) << mean << " ms, "
+					<< pixelsPerSecond * 1e-6 << " Mpixels/s, " << trianglesPerSecond * 1e-6 << " Mtriangles/s\n";
+
+				pTimer->Stop();
+				delete pRenderer;
+				delete pTimer;
+			}
+
+			delete pJobSystem;
+		}
+
+		delete pScene;
+	}
+
+	std::cout << std::defaultfloat;
+	return static_cast<bool>(csv);
+}
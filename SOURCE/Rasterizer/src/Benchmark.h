@@ -0,0 +1,74 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <string>
+#include <vector>
+#include "Scene.h"
+
+namespace dae
+{
+	class JobSystem;
+
+	namespace Benchmark
+	{
+		// Frame time with the full-buffer clear vs the tile-flag clear, at several resolutions
+		void RunClearBenchmark(int nrOfFrames);
+
+		// Frame time, depth buffer footprint and depth resolution at several view distances, per depth format
+		void RunDepthFormatBenchmark(int nrOfFrames);
+
+		// ns per operation and millions of operations per second of the math the vertex and pixel stages are built on,
+		// each operation over nrOfOperations independent inputs, best of several runs
+		void RunMathBenchmark(int nrOfOperations);
+
+		struct FrameBenchmarkSettings
+		{
+			int width{ 1280 };
+			int height{ 720 };
+			int nrOfFrames{ 240 };
+			int nrOfWarmUpFrames{ 10 };
+			float timestep{ 1.f / 60.f };	// seconds of camera path per frame, independent of how long a frame takes
+			SceneFiles sceneFiles{};
+			std::string cameraPath{};		// CameraPath file, the default path when empty
+			std::string jsonPath{};			// report goes to stdout when empty
+			std::string tracePath{};		// Chrome trace of the measured frames when not empty
+			bool perfCounters{ false };		// hardware counters per stage, Linux only
+		};
+
+		// options after "--bench" or "--check-alloc", prints the usage and returns false on anything it doesn't understand
+		bool ParseFrameBenchmarkSettings(int argc, char* argv[], FrameBenchmarkSettings& settings);
+
+		// Replays the camera path headless at a fixed timestep and reports frame time and per-stage statistics
+		// (mean, median, p95, p99, min, max in ms) as JSON, plus a checksum of the last frame to catch output changes.
+		// Returns false if the camera path or the scene can't be loaded, or the mesh has no triangles
+		bool RunFrameBenchmark(const FrameBenchmarkSettings& settings, JobSystem* pJobSystem);
+
+		// Heap allocations per stage while replaying the camera path like RunFrameBenchmark: first of a warm-up that
+		// covers the whole path, then of the measured frames. Returns false if any measured (steady-state) frame allocated
+		// or the run can't start, like RunFrameBenchmark
+		bool RunAllocationCheck(const FrameBenchmarkSettings& settings, JobSystem* pJobSystem);
+
+		struct SweepSettings
+		{
+			SceneFiles sceneFiles{};
+			std::vector<int> heights{ 480, 720, 1080, 1440, 2160, 4320 };	// 16:9, 480p up to 8K
+			std::vector<int> nrOfInstances{ 1, 4, 16 };						// vehicles on a grid, see Scene
+			std::vector<int> nrOfWorkers{ 0, -1 };							// -1 -> the job system default
+			int nrOfFrames{ 20 };
+			int nrOfWarmUpFrames{ 3 };
+			bool pinWorkers{ false };
+			std::string csvPath{ "sweep.csv" };
+		};
+
+		// options after "--sweep", prints the usage and returns false on anything it doesn't understand
+		bool ParseSweepSettings(int argc, char* argv[], SweepSettings& settings);
+
+		// Headless frame time of every combination of resolution, number of vehicle instances and worker threads,
+		// the camera framing all instances. One CSV row per combination with frame time (mean, median, min in ms),
+		// pixels/s and triangles/s (triangles submitted); rows are written as they finish.
+		// Returns false if the scene can't be loaded, the mesh has no triangles or the CSV can't be written
+		bool RunSweep(const SweepSettings& settings);
+	}
+}
+
+#endif // !BENCHMARK_H
@@ -0,0 +1,91 @@
+//Standard includes
+#include <cassert>
+#include <fstream>
+#include <sstream>
+
+//Project includes
+#include "CameraPath.h"
+#include "Renderer.h"
+
+using namespace dae;
+
+CameraPath CameraPath::CreateDefault()
+{
+	constexpr int nrOfKeys{ 17 };
+	constexpr float duration{ 8.f };
+
+	CameraPath path{};
+	for (int keyIdx{}; keyIdx < nrOfKeys; ++keyIdx)
+	{
+		const float progress{ keyIdx / static_cast<float>(nrOfKeys - 1) };
+		const float angle{ progress * 2.f * PI };
+
+		// 40 to 80 units out and 0 to 20 up, starting at the default view
+		const float radius{ 60.f + 20.f * sinf(2.f * angle) };
+		const float height{ 10.f - 10.f * cosf(angle) };
+		const Vector3 origin{ radius * sinf(0.5f * angle), 5.f + height, -radius * cosf(0.5f * angle) };
+
+		path.m_Keys.push_back({ progress * duration, origin, { 0.f, 0.f, 0.f }, progress * 360.f });
+	}
+	return path;
+}
+
+bool CameraPath::LoadFromFile(const std::string& path)
+{
+	std::ifstream file{ path };
+	if (!file) return false;
+
+	m_Keys.clear();
+
+	std::string line{};
+	while (std::getline(file, line))
+	{
+		const size_t commentStart{ line.find('#') };
+		if (commentStart != std::string::npos) line.erase(commentStart);
+
+		std::istringstream values{ line };
+		Key key{};
+		if (values >> key.time >> key.origin.x >> key.origin.y >> key.origin.z >> key.target.x >> key.target.y >> key.target.z >> key.meshAngle)
+		{
+			m_Keys.push_back(key);
+		}
+	}
+
+	return !m_Keys.empty();
+}
+
+void CameraPath::Apply(Renderer& renderer, float time) const
+{
+	const Key key{ Sample(time) };
+	renderer.SetCameraLookAt(key.origin, key.target);
+	renderer.SetMeshRotation(key.meshAngle * TO_RADIANS);
+}
+
+CameraPath::Key CameraPath::Sample(float time) const
+{
+	assert(!m_Keys.empty());
+
+	if (time <= m_Keys.front().time) return m_Keys.front();
+	if (time >= m_Keys.back().time) return m_Keys.back();
+
+	size_t nextIdx{ 1 };
+	while (m_Keys[nextIdx].time < time) ++nextIdx;
+
+	const Key& previous{ m_Keys[nextIdx - 1] };
+	const Key& next{ m_Keys[nextIdx] };
+	const float span{ next.time - previous.time };
+	const float factor{ span > 0.f ? (time - previous.time) / span : 1.f };
+
+	return
+	{
+		time,
+		previous.origin + (next.origin - previous.origin) * factor,
+		previous.target + (next.target - previous.target) * factor,
+		Lerpf(previous.meshAngle, next.meshAngle, factor)
+	};
+}
+
+float CameraPath::GetDuration() const
+{
+	return m_Keys.empty() ? 0.f : m_Keys.back().time;
+}
@@ -0,0 +1,41 @@
+#ifndef CAMERAPATH_H
+#define CAMERAPATH_H
+
+#include <string>
+#include <vector>
+#include "Maths.h"
+
+namespace dae
+{
+	class Renderer;
+
+	// Scripted camera and mesh rotation, sampled by time so a fixed timestep replays exactly the same frames
+	class CameraPath final
+	{
+	public:
+		struct Key
+		{
+			float time;			// seconds
+			Vector3 origin;
+			Vector3 target;
+			float meshAngle;	// degrees
+		};
+
+		// 8 second loop: a full mesh turn while the camera circles, dips and dollies in and out
+		static CameraPath CreateDefault();
+
+		// one key per line: "time originX originY originZ targetX targetY targetZ meshAngle", # starts a comment.
+		// Keys have to be in time order, returns false if the file can't be read or holds no keys
+		bool LoadFromFile(const std::string& path);
+
+		// camera and mesh placed at time, linear between keys and clamped to the first/last one
+		void Apply(Renderer& renderer, float time) const;
+		Key Sample(float time) const;
+		float GetDuration() const;
+
+	private:
+		std::vector<Key> m_Keys{};
+	};
+}
+
+#endif // !CAMERAPATH_H
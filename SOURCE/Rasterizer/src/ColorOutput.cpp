@@ -0,0 +1,130 @@
+//External includes
+#include <cmath>
+#include "SDL.h"
+
+//Project includes
+#include "ColorOutput.h"
+
+using namespace dae;
+
+ColorOutput::ColorOutput(const SDL_PixelFormat* pFormat)
+	: m_pFormat{ pFormat }
+{
+	// only 32-bit layouts with full 8-bit channels can be packed with plain shifts
+	m_IsDirect =
+		pFormat->BytesPerPixel == 4 &&
+		pFormat->Rloss == 0 && pFormat->Gloss == 0 && pFormat->Bloss == 0;
+
+	m_RShift = pFormat->Rshift;
+	m_GShift = pFormat->Gshift;
+	m_BShift = pFormat->Bshift;
+	m_AlphaMask = pFormat->Amask; // SDL_MapRGB makes pixels fully opaque as well
+
+	// linear [0, 1] -> 8-bit sRGB
+	for (int idx{}; idx < SRGB_TABLE_SIZE; ++idx)
+	{
+		const float linear{ idx / static_cast<float>(SRGB_TABLE_SIZE - 1) };
+		const float encoded{ linear <= 0.0031308f ? linear * 12.92f : 1.055f * powf(linear, 1.f / 2.4f) - 0.055f };
+		m_SRGBTable[idx] = static_cast<uint8_t>(Saturate(encoded) * 255.f + 0.5f);
+	}
+}
+
+void ColorOutput::Pack(const ColorRGBx4& colors, uint32_t* pPixels) const
+{
+	if (!m_IsDirect)
+	{
+		ColorRGB laneColors[SIMD_WIDTH];
+		colors.ToArray(laneColors);
+
+		for (int lane{}; lane < SIMD_WIDTH; ++lane)
+		{
+			pPixels[lane] = Pack(laneColors[lane]);
+		}
+		return;
+	}
+
+	const __m128 zero{ _mm_setzero_ps() };
+	const __m128 one{ _mm_set1_ps(1.f) };
+
+	ColorRGBx4 mapped{ colors * _mm_set1_ps(m_Exposure) };
+	switch (m_ToneMapper)
+	{
+	case ToneMapper::MaxToOne:
+	{
+		const __m128 maxValue{ _mm_max_ps(mapped.r, _mm_max_ps(mapped.g, mapped.b)) };
+		mapped = mapped * _mm_div_ps(one, _mm_max_ps(maxValue, one));
+		break;
+	}
+	case ToneMapper::Reinhard:
+		mapped.r = _mm_div_ps(mapped.r, _mm_add_ps(one, mapped.r));
+		mapped.g = _mm_div_ps(mapped.g, _mm_add_ps(one, mapped.g));
+		mapped.b = _mm_div_ps(mapped.b, _mm_add_ps(one, mapped.b));
+		break;
+	case ToneMapper::ACES:
+	{
+		const auto aces
+		{
+			[](__m128 x)
+			{
+				const __m128 numerator{ _mm_mul_ps(x, _mm_add_ps(_mm_mul_ps(_mm_set1_ps(2.51f), x), _mm_set1_ps(0.03f))) };
+				const __m128 denominator{ _mm_add_ps(_mm_mul_ps(x, _mm_add_ps(_mm_mul_ps(_mm_set1_ps(2.43f), x), _mm_set1_ps(0.59f))), _mm_set1_ps(0.14f)) };
+				return _mm_div_ps(numerator, denominator);
+			}
+		};
+		mapped = { aces(mapped.r), aces(mapped.g), aces(mapped.b) };
+		break;
+	}
+	}
+
+	mapped.r = _mm_min_ps(_mm_max_ps(mapped.r, zero), one);
+	mapped.g = _mm_min_ps(_mm_max_ps(mapped.g, zero), one);
+	mapped.b = _mm_min_ps(_mm_max_ps(mapped.b, zero), one);
+
+	if (m_SRGBEncode)
+	{
+		// table lookups are a gather, done per lane
+		const __m128 tableScale{ _mm_set1_ps(static_cast<float>(SRGB_TABLE_SIZE - 1)) };
+		const __m128 half{ _mm_set1_ps(0.5f) };
+
+		alignas(16) int rs[SIMD_WIDTH];
+		alignas(16) int gs[SIMD_WIDTH];
+		alignas(16) int bs[SIMD_WIDTH];
+		_mm_store_si128(reinterpret_cast<__m128i*>(rs), _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(mapped.r, tableScale), half)));
+		_mm_store_si128(reinterpret_cast<__m128i*>(gs), _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(mapped.g, tableScale), half)));
+		_mm_store_si128(reinterpret_cast<__m128i*>(bs), _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(mapped.b, tableScale), half)));
+
+		for (int lane{}; lane < SIMD_WIDTH; ++lane)
+		{
+			pPixels[lane] = m_AlphaMask
+				| (static_cast<uint32_t>(m_SRGBTable[rs[lane]]) << m_RShift)
+				| (static_cast<uint32_t>(m_SRGBTable[gs[lane]]) << m_GShift)
+				| (static_cast<uint32_t>(m_SRGBTable[bs[lane]]) << m_BShift);
+		}
+		return;
+	}
+
+	const __m128 byteScale{ _mm_set1_ps(255.f) };
+	const __m128 half{ _mm_set1_ps(0.5f) };
+
+	const __m128i r{ _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(mapped.r, byteScale), half)) };
+	const __m128i g{ _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(mapped.g, byteScale), half)) };
+	const __m128i b{ _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(mapped.b, byteScale), half)) };
+
+	__m128i packed{ _mm_set1_epi32(static_cast<int>(m_AlphaMask)) };
+	packed = _mm_or_si128(packed, _mm_sll_epi32(r, _mm_cvtsi32_si128(static_cast<int>(m_RShift))));
+	packed = _mm_or_si128(packed, _mm_sll_epi32(g, _mm_cvtsi32_si128(static_cast<int>(m_GShift))));
+	packed = _mm_or_si128(packed, _mm_sll_epi32(b, _mm_cvtsi32_si128(static_cast<int>(m_BShift))));
+
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(pPixels), packed);
+}
+
+uint32_t ColorOutput::MapRGB(const ColorRGB& color) const
+{
+	return SDL_MapRGB
+	(
+		m_pFormat,
+		static_cast<uint8_t>(Encode(color.r)),
+		static_cast<uint8_t>(Encode(color.g)),
+		static_cast<uint8_t>(Encode(color.b))
+	);
+}
@@ -0,0 +1,110 @@
+#ifndef COLOROUTPUT_H
+#define COLOROUTPUT_H
+
+#include <cstdint>
+
+#include "ColorRGB.h"
+#include "SIMD.h"
+
+struct SDL_PixelFormat;
+
+namespace dae
+{
+	enum class ToneMapper
+	{
+		MaxToOne = 0,
+		Reinhard,
+		ACES
+	};
+
+	// Converts shaded float colors to the backbuffer's 32-bit pixel layout without going through SDL_MapRGB
+	class ColorOutput final
+	{
+	public:
+		explicit ColorOutput(const SDL_PixelFormat* pFormat);
+		~ColorOutput() = default;
+
+		ColorOutput(const ColorOutput&) = delete;
+		ColorOutput(ColorOutput&&) noexcept = delete;
+		ColorOutput& operator=(const ColorOutput&) = delete;
+		ColorOutput& operator=(ColorOutput&&) noexcept = delete;
+
+		// exposure + tonemap + optional sRGB encode + pack
+		uint32_t Pack(const ColorRGB& color) const
+		{
+			ColorRGB mapped{ color * m_Exposure };
+			ToneMap(mapped);
+			return PackClamped(mapped);
+		}
+
+		// clamp to [0, 1] + optional sRGB encode + pack, no tonemapping (debug views)
+		uint32_t PackClamped(const ColorRGB& color) const
+		{
+			if (!m_IsDirect) return MapRGB(color);
+
+			return m_AlphaMask
+				| (Encode(color.r) << m_RShift)
+				| (Encode(color.g) << m_GShift)
+				| (Encode(color.b) << m_BShift);
+		}
+
+		// SIMD_WIDTH colors at once into pPixels[0..SIMD_WIDTH)
+		void Pack(const ColorRGBx4& colors, uint32_t* pPixels) const;
+
+		void SetToneMapper(ToneMapper toneMapper) { m_ToneMapper = toneMapper; };
+		ToneMapper GetToneMapper() const { return m_ToneMapper; };
+		void SetSRGBEncode(bool isEnabled) { m_SRGBEncode = isEnabled; };
+		bool GetSRGBEncode() const { return m_SRGBEncode; };
+		void SetExposure(float exposure) { m_Exposure = exposure; };
+		float GetExposure() const { return m_Exposure; };
+
+	private:
+		static constexpr int SRGB_TABLE_SIZE{ 4096 };
+
+		void ToneMap(ColorRGB& color) const
+		{
+			switch (m_ToneMapper)
+			{
+			case ToneMapper::MaxToOne:
+				color.MaxToOne();
+				break;
+			case ToneMapper::Reinhard:
+				color = { color.r / (1.f + color.r), color.g / (1.f + color.g), color.b / (1.f + color.b) };
+				break;
+			case ToneMapper::ACES:
+				color = { ACES(color.r), ACES(color.g), ACES(color.b) };
+				break;
+			}
+		}
+
+		uint32_t Encode(float channel) const
+		{
+			channel = Saturate(channel);
+			if (m_SRGBEncode) return m_SRGBTable[static_cast<int>(channel * (SRGB_TABLE_SIZE - 1) + 0.5f)];
+			return static_cast<uint32_t>(channel * 255.f + 0.5f);
+		}
+
+		// Narkowicz's fit of the ACES filmic curve
+		static float ACES(float x)
+		{
+			return (x * (2.51f * x + 0.03f)) / (x * (2.43f * x + 0.59f) + 0.14f);
+		}
+
+		uint32_t MapRGB(const ColorRGB& color) const;
+
+		const SDL_PixelFormat* m_pFormat;
+		bool m_IsDirect{};
+
+		uint32_t m_RShift{};
+		uint32_t m_GShift{};
+		uint32_t m_BShift{};
+		uint32_t m_AlphaMask{};
+
+		ToneMapper m_ToneMapper{ ToneMapper::MaxToOne };
+		bool m_SRGBEncode{ false };
+		float m_Exposure{ 1.f };
+		uint8_t m_SRGBTable[SRGB_TABLE_SIZE]{};
+	};
+}
+
+#endif // !COLOROUTPUT_H
@@ -0,0 +1,28 @@
+//Standard includes
+#include <charconv>
+#include <cmath>
+
+//Project includes
+#include "CommandLine.h"
+
+using namespace dae;
+
+bool CommandLine::ParseValue(std::string_view text, int& value)
+{
+	int parsedValue{};
+	const std::from_chars_result result{ std::from_chars(text.data(), text.data() + text.size(), parsedValue) };
+	if (result.ec != std::errc{} || result.ptr != text.data() + text.size()) return false;
+
+	value = parsedValue;
+	return true;
+}
+
+bool CommandLine::ParseValue(std::string_view text, float& value)
+{
+	float parsedValue{};
+	const std::from_chars_result result{ std::from_chars(text.data(), text.data() + text.size(), parsedValue) };
+	if (result.ec != std::errc{} || result.ptr != text.data() + text.size() || !std::isfinite(parsedValue)) return false;
+
+	value = parsedValue;
+	return true;
+}
@@ -0,0 +1,17 @@
+#ifndef COMMANDLINE_H
+#define COMMANDLINE_H
+
+#include <string_view>
+
+namespace dae
+{
+	// Number arguments of the command line modes. The whole text has to be the number, anything else
+	// returns false and leaves value as it was, so the caller can print its usage instead of throwing
+	namespace CommandLine
+	{
+		bool ParseValue(std::string_view text, int& value);
+		bool ParseValue(std::string_view text, float& value);
+	}
+}
+
+#endif // !COMMANDLINE_H
@@ -0,0 +1,203 @@
+//External includes
+#include <cassert>
+#include "SDL.h"
+#include "SDL_surface.h"
+
+//Project includes
+#include "AllocationTracker.h"
+#include "FramePresenter.h"
+#include "Trace.h"
+
+using namespace dae;
+
+FramePresenter::FramePresenter(SDL_Window* pWindow, const SDL_PixelFormat* pFormat, int width, int height)
+	: m_pWindow{ pWindow }
+{
+	m_pFrontBuffer = SDL_GetWindowSurface(pWindow);
+
+	for (int frameIdx{}; frameIdx < NR_OF_FRAMES; ++frameIdx)
+	{
+		m_pFrames[frameIdx] = SDL_CreateRGBSurfaceWithFormat(0, width, height, pFormat->BitsPerPixel, pFormat->format);
+		m_FrameStates[frameIdx] = FrameState::Free;
+	}
+
+	m_PresentThread = std::thread{ &FramePresenter::PresentLoop, this };
+}
+
+FramePresenter::~FramePresenter()
+{
+	// frames that are still queued get presented before the thread exits
+	WaitUntilIdle();
+	{
+		const std::lock_guard lock{ m_Mutex };
+		m_IsRunning = false;
+	}
+	m_FrameQueued.notify_one();
+	m_PresentThread.join();
+
+	for (SDL_Surface* pFrame : m_pFrames)
+	{
+		if (pFrame) SDL_FreeSurface(pFrame);
+	}
+}
+
+SDL_Surface* FramePresenter::AcquireFrame()
+{
+	std::unique_lock lock{ m_Mutex };
+	while (true)
+	{
+		// this runs once per frame on the main thread, whatever got blitted since gets shown here
+		if (m_IsWindowUpdatePending)
+		{
+			UpdateWindow(lock);
+			continue;
+		}
+
+		for (int frameIdx{}; frameIdx < NR_OF_FRAMES; ++frameIdx)
+		{
+			if (m_FrameStates[frameIdx] == FrameState::Free)
+			{
+				m_FrameStates[frameIdx] = FrameState::Rendering;
+				return m_pFrames[frameIdx];
+			}
+		}
+
+		if (m_Policy == PresentPolicy::DropOldest && m_NrOfQueuedFrames > 0)
+		{
+			// the oldest queued frame never makes it to the screen
+			const int frameIdx{ m_QueuedFrames[m_FirstQueuedFrame] };
+			m_FirstQueuedFrame = (m_FirstQueuedFrame + 1) % NR_OF_FRAMES;
+			--m_NrOfQueuedFrames;
+			++m_NrOfDroppedFrames;
+
+			m_FrameStates[frameIdx] = FrameState::Rendering;
+			return m_pFrames[frameIdx];
+		}
+
+		m_FrameFreed.wait(lock);
+	}
+}
+
+void FramePresenter::SubmitFrame(SDL_Surface* pFrame)
+{
+	{
+		const std::lock_guard lock{ m_Mutex };
+		const int frameIdx{ FindFrame(pFrame) };
+		assert(frameIdx >= 0 && m_FrameStates[frameIdx] == FrameState::Rendering);
+
+		m_FrameStates[frameIdx] = FrameState::Queued;
+		m_QueuedFrames[(m_FirstQueuedFrame + m_NrOfQueuedFrames) % NR_OF_FRAMES] = frameIdx;
+		++m_NrOfQueuedFrames;
+	}
+	m_FrameQueued.notify_one();
+}
+
+void FramePresenter::WaitUntilIdle()
+{
+	std::unique_lock lock{ m_Mutex };
+	while (true)
+	{
+		if (m_IsWindowUpdatePending)
+		{
+			UpdateWindow(lock);
+		}
+		else if (m_NrOfQueuedFrames == 0 && !m_IsBlitting)
+		{
+			return;
+		}
+		else
+		{
+			m_FrameFreed.wait(lock);
+		}
+	}
+}
+
+void FramePresenter::SetPolicy(PresentPolicy policy)
+{
+	{
+		const std::lock_guard lock{ m_Mutex };
+		m_Policy = policy;
+	}
+
+	// a render thread waiting under Block may be able to drop a frame now
+	m_FrameFreed.notify_one();
+}
+
+PresentPolicy FramePresenter::GetPolicy() const
+{
+	const std::lock_guard lock{ m_Mutex };
+	return m_Policy;
+}
+
+int FramePresenter::GetNrOfPresentedFrames() const
+{
+	const std::lock_guard lock{ m_Mutex };
+	return m_NrOfPresentedFrames;
+}
+
+int FramePresenter::GetNrOfDroppedFrames() const
+{
+	const std::lock_guard lock{ m_Mutex };
+	return m_NrOfDroppedFrames;
+}
+
+void FramePresenter::PresentLoop()
+{
+	Trace::SetThreadName("Present");
+	const Allocations::Scope presentAllocations{ Allocations::Stage::Present };
+
+	while (true)
+	{
+		int frameIdx{};
+		{
+			std::unique_lock lock{ m_Mutex };
+			// the window surface can't be written while the main thread shows it
+			m_FrameQueued.wait(lock, [this] { return (m_NrOfQueuedFrames > 0 && !m_IsWindowUpdatePending) || !m_IsRunning; });
+			if (!m_IsRunning) return;
+
+			frameIdx = m_QueuedFrames[m_FirstQueuedFrame];
+			m_FirstQueuedFrame = (m_FirstQueuedFrame + 1) % NR_OF_FRAMES;
+			--m_NrOfQueuedFrames;
+			m_FrameStates[frameIdx] = FrameState::Presenting;
+			m_IsBlitting = true;
+		}
+
+		// software surfaces only, a CPU copy and format conversion; SDL_UpdateWindowSurface is left to the main thread
+		{
+			const Trace::Zone presentZone{ "Present", frameIdx };
+			SDL_BlitSurface(m_pFrames[frameIdx], nullptr, m_pFrontBuffer, nullptr);
+		}
+
+		{
+			const std::lock_guard lock{ m_Mutex };
+			m_FrameStates[frameIdx] = FrameState::Free;
+			m_IsBlitting = false;
+			m_IsWindowUpdatePending = true;
+			++m_NrOfPresentedFrames;
+		}
+		m_FrameFreed.notify_one();
+	}
+}
+
+void FramePresenter::UpdateWindow(std::unique_lock<std::mutex>& lock)
+{
+	// the present thread waits for the flag, the window surface is all ours until it's cleared
+	lock.unlock();
+	{
+		const Trace::Zone updateZone{ "UpdateWindow" };
+		SDL_UpdateWindowSurface(m_pWindow);
+	}
+	lock.lock();
+
+	m_IsWindowUpdatePending = false;
+	m_FrameQueued.notify_one();
+}
+
+int FramePresenter::FindFrame(const SDL_Surface* pFrame) const
+{
+	for (int frameIdx{}; frameIdx < NR_OF_FRAMES; ++frameIdx)
+	{
+		if (m_pFrames[frameIdx] == pFrame) return frameIdx;
+	}
+	return -1;
+}
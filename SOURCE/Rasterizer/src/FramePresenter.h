@@ -0,0 +1,89 @@
+#ifndef FRAMEPRESENTER_H
+#define FRAMEPRESENTER_H
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+struct SDL_Window;
+struct SDL_Surface;
+struct SDL_PixelFormat;
+
+namespace dae
+{
+	enum class PresentPolicy
+	{
+		Block = 0,	// throughput: every frame gets presented, rendering waits for a free buffer
+		DropOldest	// latency: rendering never waits, the oldest frame still waiting to be presented is reused
+	};
+
+	// Blits finished frames into the window surface on its own thread, out of a ring of NR_OF_FRAMES surfaces,
+	// so the next frame can be rasterized while the previous one is copied. SDL wants the window updated from
+	// the thread that created it, that part stays with UpdateWindow on the main thread
+	class FramePresenter final
+	{
+	public:
+		static constexpr int NR_OF_FRAMES{ 3 };
+
+		FramePresenter(SDL_Window* pWindow, const SDL_PixelFormat* pFormat, int width, int height);
+		~FramePresenter();
+
+		FramePresenter(const FramePresenter&) = delete;
+		FramePresenter(FramePresenter&&) noexcept = delete;
+		FramePresenter& operator=(const FramePresenter&) = delete;
+		FramePresenter& operator=(FramePresenter&&) noexcept = delete;
+
+		// main thread: surface to render the next frame into, hand it back with SubmitFrame from any thread
+		SDL_Surface* AcquireFrame();
+		void SubmitFrame(SDL_Surface* pFrame);
+
+		// main thread: returns once every submitted frame is blitted and shown, the present thread is idle after
+		void WaitUntilIdle();
+
+		void SetPolicy(PresentPolicy policy);
+		PresentPolicy GetPolicy() const;
+		int GetNrOfPresentedFrames() const;
+		int GetNrOfDroppedFrames() const;
+
+	private:
+
+		enum class FrameState
+		{
+			Free,
+			Rendering,
+			Queued,
+			Presenting
+		};
+
+		void PresentLoop();
+		void UpdateWindow(std::unique_lock<std::mutex>& lock);
+		int FindFrame(const SDL_Surface* pFrame) const;
+
+		SDL_Window* m_pWindow;
+		SDL_Surface* m_pFrontBuffer;
+
+		SDL_Surface* m_pFrames[NR_OF_FRAMES]{};
+		FrameState m_FrameStates[NR_OF_FRAMES]{};
+
+		// frames waiting for present, oldest first
+		int m_QueuedFrames[NR_OF_FRAMES]{};
+		int m_FirstQueuedFrame{};
+		int m_NrOfQueuedFrames{};
+
+		mutable std::mutex m_Mutex;
+		std::condition_variable m_FrameQueued;
+		std::condition_variable m_FrameFreed;
+		std::thread m_PresentThread;
+		bool m_IsRunning{ true };
+
+		// the window surface holds a frame the main thread hasn't shown yet, the next blit waits for it
+		bool m_IsWindowUpdatePending{ false };
+		bool m_IsBlitting{ false };
+
+		PresentPolicy m_Policy{ PresentPolicy::Block };
+		int m_NrOfPresentedFrames{};
+		int m_NrOfDroppedFrames{};
+	};
+}
+
+#endif // !FRAMEPRESENTER_H
@@ -0,0 +1,77 @@
+//Project includes
+#include "FrameWorker.h"
+#include "Trace.h"
+
+using namespace dae;
+
+FrameWorker::FrameWorker()
+{
+	m_Thread = std::thread{ &FrameWorker::WorkLoop, this };
+}
+
+FrameWorker::~FrameWorker()
+{
+	// the job in flight gets to finish
+	{
+		const std::lock_guard lock{ m_Mutex };
+		m_IsRunning = false;
+	}
+	m_JobSubmitted.notify_one();
+	m_Thread.join();
+}
+
+void FrameWorker::Submit(const std::function<void()>& job)
+{
+	{
+		std::unique_lock lock{ m_Mutex };
+		m_JobDone.wait(lock, [this] { return !m_HasJob; });
+
+		m_Job = job;
+		m_HasJob = true;
+	}
+	m_JobSubmitted.notify_one();
+}
+
+void FrameWorker::Wait()
+{
+	std::unique_lock lock{ m_Mutex };
+	m_JobDone.wait(lock, [this] { return !m_HasJob; });
+}
+
+std::chrono::steady_clock::time_point FrameWorker::GetJobStart() const
+{
+	const std::lock_guard lock{ m_Mutex };
+	return m_JobStart;
+}
+
+std::chrono::steady_clock::time_point FrameWorker::GetJobEnd() const
+{
+	const std::lock_guard lock{ m_Mutex };
+	return m_JobEnd;
+}
+
+void FrameWorker::WorkLoop()
+{
+	Trace::SetThreadName("Frame worker");
+
+	while (true)
+	{
+		{
+			std::unique_lock lock{ m_Mutex };
+			m_JobSubmitted.wait(lock, [this] { return m_HasJob || !m_IsRunning; });
+			if (!m_HasJob) return;
+		}
+
+		const auto jobStart{ std::chrono::steady_clock::now() };
+		m_Job();
+		const auto jobEnd{ std::chrono::steady_clock::now() };
+
+		{
+			const std::lock_guard lock{ m_Mutex };
+			m_JobStart = jobStart;
+			m_JobEnd = jobEnd;
+			m_HasJob = false;
+		}
+		m_JobDone.notify_all();
+	}
+}
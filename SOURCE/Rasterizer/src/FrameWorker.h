@@ -0,0 +1,49 @@
+#ifndef FRAMEWORKER_H
+#define FRAMEWORKER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace dae
+{
+	// Runs one job at a time on its own thread, used to rasterize a frame while the caller moves on to the next one
+	class FrameWorker final
+	{
+	public:
+		FrameWorker();
+		~FrameWorker();
+
+		FrameWorker(const FrameWorker&) = delete;
+		FrameWorker(FrameWorker&&) noexcept = delete;
+		FrameWorker& operator=(const FrameWorker&) = delete;
+		FrameWorker& operator=(FrameWorker&&) noexcept = delete;
+
+		// waits for the previous job before handing over the new one
+		void Submit(const std::function<void()>& job);
+		void Wait();
+
+		// when the last finished job ran
+		std::chrono::steady_clock::time_point GetJobStart() const;
+		std::chrono::steady_clock::time_point GetJobEnd() const;
+
+	private:
+		void WorkLoop();
+
+		std::function<void()> m_Job;
+		bool m_HasJob{};
+		bool m_IsRunning{ true };
+
+		std::chrono::steady_clock::time_point m_JobStart{};
+		std::chrono::steady_clock::time_point m_JobEnd{};
+
+		mutable std::mutex m_Mutex;
+		std::condition_variable m_JobSubmitted;
+		std::condition_variable m_JobDone;
+		std::thread m_Thread;
+	};
+}
+
+#endif // !FRAMEWORKER_H
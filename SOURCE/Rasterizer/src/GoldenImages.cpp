@@ -0,0 +1,293 @@
+//Standard includes
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+
+//External includes
+#include "SDL.h"
+
+//Project includes
+#include "CommandLine.h"
+#include "GoldenImages.h"
+#include "JobSystem.h"
+#include "Maths.h"
+#include "Renderer.h"
+#include "Timer.h"
+
+using namespace dae;
+
+namespace
+{
+	struct Shot
+	{
+		const char* pName;
+		Vector3 origin;
+		Vector3 target;
+		float meshAngle;	// degrees
+	};
+
+	// changing a shot invalidates its references
+	const Shot SHOTS[]
+	{
+		{ "front", { 0.f, 5.f, -64.f }, { 0.f, 5.f, 0.f }, 0.f },		// the view the windowed renderer starts with
+		{ "side", { 0.f, 5.f, -64.f }, { 0.f, 5.f, 0.f }, 90.f },
+		{ "close", { 8.f, 9.f, -28.f }, { 0.f, 3.f, 0.f }, 35.f },		// texture and normal map detail, specular highlights
+		{ "above", { 0.f, 45.f, -40.f }, { 0.f, 0.f, 0.f }, 210.f }
+	};
+
+	struct ShadingModeName
+	{
+		Renderer::ShadingMode shadingMode;
+		Renderer::SpecularModel specularModel;
+		const char* pName;
+	};
+
+	const ShadingModeName SHADING_MODES[]
+	{
+		{ Renderer::ShadingMode::observedArea, Renderer::SpecularModel::phong, "observedArea" },
+		{ Renderer::ShadingMode::diffused, Renderer::SpecularModel::phong, "diffused" },
+		{ Renderer::ShadingMode::specular, Renderer::SpecularModel::phong, "specular" },
+		{ Renderer::ShadingMode::specular, Renderer::SpecularModel::blinnPhong, "specularBlinnPhong" },
+		{ Renderer::ShadingMode::combined, Renderer::SpecularModel::phong, "combined" }
+	};
+
+	// frames per shot, the fastest one is reported
+	constexpr int NR_OF_TIMED_FRAMES{ 3 };
+
+	struct Comparison
+	{
+		int maxDifference;			// largest difference of any channel
+		int nrOfDifferentPixels;	// pixels with a channel differing by more than the tolerance
+		double psnr;				// dB over all channels, infinity when identical
+	};
+
+	// pixels 0x00RRGGBB tightly packed, pReference in RGB888 of the same size
+	Comparison Compare(const uint32_t* pPixels, const SDL_Surface* pReference, int tolerance)
+	{
+		Comparison comparison{ 0, 0, std::numeric_limits<double>::infinity() };
+		double squaredErrorSum{};
+
+		for (int py{}; py < pReference->h; ++py)
+		{
+			const uint32_t* pReferenceRow{ reinterpret_cast<const uint32_t*>(static_cast<const uint8_t*>(pReference->pixels) + py * pReference->pitch) };
+			for (int px{}; px < pReference->w; ++px)
+			{
+				const uint32_t pixel{ pPixels[px + py * pReference->w] };
+				const uint32_t referencePixel{ pReferenceRow[px] };
+
+				int pixelDifference{};
+				for (int shift{}; shift < 24; shift += 8)
+				{
+					const int difference{ std::abs(static_cast<int>((pixel >> shift) & 0xFF) - static_cast<int>((referencePixel >> shift) & 0xFF)) };
+					pixelDifference = std::max(pixelDifference, difference);
+					squaredErrorSum += difference * difference;
+				}
+
+				comparison.maxDifference = std::max(comparison.maxDifference, pixelDifference);
+				if (pixelDifference > tolerance) ++comparison.nrOfDifferentPixels;
+			}
+		}
+
+		if (squaredErrorSum > 0.0)
+		{
+			const double meanSquaredError{ squaredErrorSum / (3.0 * pReference->w * pReference->h) };
+			comparison.psnr = 10.0 * std::log10(255.0 * 255.0 / meanSquaredError);
+		}
+		return comparison;
+	}
+
+	// reference dimmed to a quarter, pixels past the tolerance in red; returns false if it can't be written
+	bool SaveDifference(const std::string& path, const uint32_t* pPixels, const SDL_Surface* pReference, int tolerance)
+	{
+		SDL_Surface* pDifference{ SDL_CreateRGBSurfaceWithFormat(0, pReference->w, pReference->h, 32, SDL_PIXELFORMAT_RGB888) };
+		if (!pDifference) return false;
+
+		for (int py{}; py < pReference->h; ++py)
+		{
+			const uint32_t* pReferenceRow{ reinterpret_cast<const uint32_t*>(static_cast<const uint8_t*>(pReference->pixels) + py * pReference->pitch) };
+			uint32_t* pDifferenceRow{ reinterpret_cast<uint32_t*>(static_cast<uint8_t*>(pDifference->pixels) + py * pDifference->pitch) };
+			for (int px{}; px < pReference->w; ++px)
+			{
+				const uint32_t pixel{ pPixels[px + py * pReference->w] };
+				const uint32_t referencePixel{ pReferenceRow[px] };
+
+				int pixelDifference{};
+				for (int shift{}; shift < 24; shift += 8)
+				{
+					pixelDifference = std::max(pixelDifference, std::abs(static_cast<int>((pixel >> shift) & 0xFF) - static_cast<int>((referencePixel >> shift) & 0xFF)));
+				}
+				pDifferenceRow[px] = pixelDifference > tolerance ? 0x00FF0000 : (referencePixel >> 2) & 0x003F3F3F;
+			}
+		}
+
+		const bool isSaved{ SDL_SaveBMP(pDifference, path.c_str()) == 0 };
+		SDL_FreeSurface(pDifference);
+		return isSaved;
+	}
+
+	void PrintUsage()
+	{
+		std::cout
+			<< "--golden [options]\n"
+			<< "  --update           render the references instead of comparing against them\n"
+			<< "  --dir DIR          reference directory (Resources/Golden)\n"
+			<< "  --out DIR          where failing shots write their difference image (next to the references)\n"
+			<< "  --size W H         resolution (320 240), has to match the references\n"
+			<< "  --tolerance N      per channel difference a pixel may have (8)\n"
+			<< "  --max-pixels P     percent of pixels allowed past the tolerance (0.1)\n"
+			<< "  --min-psnr DB      lowest PSNR that passes (40)\n"
+			<< "  --threads N, --pin job system workers\n";
+	}
+}
+
+bool GoldenImages::ParseSettings(int argc, char* argv[], Settings& settings)
+{
+	for (int argIdx{ 2 }; argIdx < argc; ++argIdx)
+	{
+		const std::string argument{ argv[argIdx] };
+		const int nrOfValues{ argc - 1 - argIdx };
+
+		bool isValid{ true };
+		if (argument == "--update") settings.update = true;
+		else if (argument == "--dir" && nrOfValues >= 1) settings.directory = argv[++argIdx];
+		else if (argument == "--out" && nrOfValues >= 1) settings.outputDirectory = argv[++argIdx];
+		else if (argument == "--size" && nrOfValues >= 2)
+		{
+			isValid = CommandLine::ParseValue(argv[++argIdx], settings.width);
+			isValid = CommandLine::ParseValue(argv[++argIdx], settings.height) && isValid;
+		}
+		else if (argument == "--tolerance" && nrOfValues >= 1) isValid = CommandLine::ParseValue(argv[++argIdx], settings.tolerance);
+		else if (argument == "--max-pixels" && nrOfValues >= 1) isValid = CommandLine::ParseValue(argv[++argIdx], settings.maxDifferentPixels);
+		else if (argument == "--min-psnr" && nrOfValues >= 1) isValid = CommandLine::ParseValue(argv[++argIdx], settings.minPSNR);
+		else if (argument == "--threads" && nrOfValues >= 1) ++argIdx; // handled by main
+		else if (argument == "--pin") continue;
+		else isValid = false;
+
+		if (!isValid)
+		{
+			std::cout << "Invalid golden image option: " << argument << "\n";
+			PrintUsage();
+			return false;
+		}
+	}
+
+	if (settings.width <= 0 || settings.height <= 0 || settings.tolerance < 0)
+	{
+		PrintUsage();
+		return false;
+	}
+	return true;
+}
+
+bool GoldenImages::Run(const Settings& settings, JobSystem* pJobSystem)
+{
+	const SceneFiles& files{ settings.sceneFiles };
+	if (!files.CanOpen()) return false;
+
+	const std::string& outputDirectory{ settings.update || settings.outputDirectory.empty() ? settings.directory : settings.outputDirectory };
+	std::error_code error{};
+	std::filesystem::create_directories(outputDirectory, error);
+	if (error)
+	{
+		std::cout << "Can't create " << outputDirectory << "\n";
+		return false;
+	}
+
+	Timer* pTimer{ new Timer{} };
+	Scene* pScene{ new Scene{ files, pJobSystem } };
+	Renderer* pRenderer{ new Renderer{ settings.width, settings.height, nullptr, pJobSystem, pScene } };
+	pTimer->Start();
+
+	const int nrOfPixels{ settings.width * settings.height };
+	std::cout << (settings.update ? "Updating" : "Comparing") << " golden images in " << settings.directory
+		<< ", " << settings.width << "x" << settings.height << ", " << (pJobSystem ? pJobSystem->GetNrOfWorkers() : 0) << " workers\n"
+		<< std::fixed;
+
+	int nrOfFailedShots{};
+	for (const Shot& shot : SHOTS)
+	{
+		for (const ShadingModeName& shadingMode : SHADING_MODES)
+		{
+			const std::string name{ std::string{ shot.pName } + "_" + shadingMode.pName };
+			const std::string referencePath{ (std::filesystem::path{ settings.directory } / (name + ".bmp")).string() };
+
+			pRenderer->SetCameraLookAt(shot.origin, shot.target);
+			pRenderer->SetMeshRotation(shot.meshAngle * TO_RADIANS);
+			pRenderer->SetShadingMode(shadingMode.shadingMode);
+			pRenderer->SetSpecularModel(shadingMode.specularModel);
+
+			double renderTime{ std::numeric_limits<double>::max() };
+			for (int frame{}; frame < NR_OF_TIMED_FRAMES; ++frame)
+			{
+				const auto frameStart{ std::chrono::steady_clock::now() };
+				pRenderer->Update(pTimer);
+				pRenderer->Render();
+				pRenderer->WaitForFrame();
+				const std::chrono::duration<double, std::milli> frameTime{ std::chrono::steady_clock::now() - frameStart };
+				renderTime = std::min(renderTime, frameTime.count());
+				pTimer->Update();
+			}
+
+			std::cout << "  " << std::left << std::setw(26) << name << std::right << std::setprecision(2) << std::setw(8) << renderTime << " ms  ";
+
+			if (settings.update)
+			{
+				const bool isSaved{ !pRenderer->SaveBufferToImage(referencePath.c_str()) };
+				std::cout << (isSaved ? "written\n" : "can't be written\n");
+				if (!isSaved) ++nrOfFailedShots;
+				continue;
+			}
+
+			SDL_Surface* pLoadedReference{ SDL_LoadBMP(referencePath.c_str()) };
+			SDL_Surface* pReference{ pLoadedReference ? SDL_ConvertSurfaceFormat(pLoadedReference, SDL_PIXELFORMAT_RGB888, 0) : nullptr };
+			if (pLoadedReference) SDL_FreeSurface(pLoadedReference);
+
+			if (!pReference || pReference->w != settings.width || pReference->h != settings.height)
+			{
+				std::cout << (pReference ? "FAILED, reference has a different size\n" : "FAILED, no reference\n");
+				if (pReference) SDL_FreeSurface(pReference);
+				++nrOfFailedShots;
+				continue;
+			}
+
+			const uint32_t* pPixels{ pRenderer->GetPixels() };
+			const Comparison comparison{ Compare(pPixels, pReference, settings.tolerance) };
+			const float differentPixels{ 100.f * comparison.nrOfDifferentPixels / nrOfPixels };
+			const bool isPassed{ differentPixels <= settings.maxDifferentPixels && comparison.psnr >= settings.minPSNR };
+
+			std::cout << (isPassed ? "passed" : "FAILED") << std::setprecision(3)
+				<< ", max difference " << comparison.maxDifference
+				<< ", " << differentPixels << "% past tolerance"
+				<< ", PSNR " << std::setprecision(2) << comparison.psnr << " dB\n";
+
+			if (!isPassed)
+			{
+				++nrOfFailedShots;
+				const std::string differencePath{ (std::filesystem::path{ outputDirectory } / (name + "_diff.bmp")).string() };
+				if (SaveDifference(differencePath, pPixels, pReference, settings.tolerance)) std::cout << "    difference written to " << differencePath << "\n";
+			}
+			SDL_FreeSurface(pReference);
+		}
+	}
+
+	const int nrOfShots{ static_cast<int>(std::size(SHOTS) * std::size(SHADING_MODES)) };
+	if (nrOfFailedShots > 0)
+	{
+		std::cout << "FAILED: " << nrOfFailedShots << " of " << nrOfShots << " shots\n";
+	}
+	else
+	{
+		std::cout << (settings.update ? "Updated " : "PASSED: ") << nrOfShots << " shots\n";
+	}
+	std::cout << std::defaultfloat;
+
+	pTimer->Stop();
+	delete pRenderer;
+	delete pScene;
+	delete pTimer;
+	return nrOfFailedShots == 0;
+}
@@ -0,0 +1,42 @@
+#ifndef GOLDENIMAGES_H
+#define GOLDENIMAGES_H
+
+#include <string>
+#include "Scene.h"
+
+namespace dae
+{
+	class JobSystem;
+
+	// Image regression test: a few fixed camera shots per shading mode, rendered headless and compared against
+	// reference images committed under Resources/Golden. It renders its own mesh, committed next to the references,
+	// with the vehicle textures so a checkout has everything the test needs
+	namespace GoldenImages
+	{
+		struct Settings
+		{
+			std::string directory{ "Resources/Golden" };	// <shot>_<shading mode>.bmp
+			std::string outputDirectory{};					// <shot>_<shading mode>_diff.bmp, next to the references when empty
+			SceneFiles sceneFiles{ "Resources/Golden/torus.obj" };	// vehicle textures, the vehicle mesh isn't committed
+			bool update{ false };							// write the references instead of comparing
+			int width{ 320 };								// 20 references of 230 KB each
+			int height{ 240 };
+
+			// a shot passes with at most maxDifferentPixels percent of its pixels differing by more than tolerance
+			// in any channel, and a PSNR of at least minPSNR dB; float and SIMD paths aren't bit exact across compilers
+			int tolerance{ 8 };
+			float maxDifferentPixels{ 0.1f };
+			float minPSNR{ 40.f };
+		};
+
+		// options after "--golden", prints the usage and returns false on anything it doesn't understand
+		bool ParseSettings(int argc, char* argv[], Settings& settings);
+
+		// Renders every shot and compares or updates its reference. Prints the differences and render time per shot
+		// and writes <shot>_<shading mode>_diff.bmp to the output directory for the ones that fail.
+		// Returns false if any shot fails or has no reference
+		bool Run(const Settings& settings, JobSystem* pJobSystem);
+	}
+}
+
+#endif // !GOLDENIMAGES_H
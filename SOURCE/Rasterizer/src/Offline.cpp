@@ -0,0 +1,283 @@
+//Standard includes
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#include <psapi.h>
+#elif defined(__linux__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+//Project includes
+#include "CommandLine.h"
+#include "Offline.h"
+#include "Renderer.h"
+#include "Timer.h"
+
+using namespace dae;
+
+namespace
+{
+	// peak resident memory of the process in bytes, 0 where it can't be queried
+	size_t GetPeakMemoryUsage()
+	{
+#if defined(_WIN32)
+		PROCESS_MEMORY_COUNTERS counters{};
+		if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+		return counters.PeakWorkingSetSize;
+#elif defined(__linux__) || defined(__APPLE__)
+		rusage usage{};
+		if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#if defined(__APPLE__)
+		return static_cast<size_t>(usage.ru_maxrss); // bytes
+#else
+		return static_cast<size_t>(usage.ru_maxrss) * 1024; // kilobytes
+#endif
+#else
+		return 0;
+#endif
+	}
+
+	// every frameStep-th frame of the sequence from firstFrame on, returns the seconds spent writing images
+	double RenderBatchFrames(Renderer& renderer, const Offline::BatchSettings& settings, int firstFrame, int frameStep)
+	{
+		Timer timer{};
+		timer.Start();
+
+		if (settings.orbitRadius <= 0.f) renderer.SetCameraView({ 0.f, 5.f, -64.f }, 0.f, 0.f);
+
+		double writeTime{};
+		for (int frame{ firstFrame }; frame < settings.nrOfFrames; frame += frameStep)
+		{
+			const float progress{ frame / static_cast<float>(settings.nrOfFrames) };
+			renderer.SetMeshRotation(progress * settings.meshDegrees * TO_RADIANS);
+
+			if (settings.orbitRadius > 0.f)
+			{
+				// starts behind the mesh like the default view, looking along +z
+				const float angle{ (settings.orbitStart + progress * settings.orbitDegrees) * TO_RADIANS };
+				const Vector3 origin{ settings.orbitRadius * sinf(angle), settings.orbitHeight, -settings.orbitRadius * cosf(angle) };
+				renderer.SetCameraLookAt(origin, { 0.f, 0.f, 0.f });
+			}
+
+			renderer.Update(&timer);
+			renderer.Render();
+			timer.Update();
+
+			if (!settings.outputPrefix.empty())
+			{
+				std::ostringstream path{};
+				path << settings.outputPrefix << "_" << std::setw(4) << std::setfill('0') << frame << ".bmp";
+
+				const auto writeStart{ std::chrono::steady_clock::now() };
+				if (renderer.SaveBufferToImage(path.str().c_str()))
+				{
+					std::cout << "Something went wrong. " + path.str() + " not saved!\n";
+				}
+				writeTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - writeStart).count();
+			}
+		}
+		renderer.WaitForFrame();
+
+		timer.Stop();
+		return writeTime;
+	}
+
+	void PrintBatchUsage()
+	{
+		std::cout
+			<< "--batch [options]\n"
+			<< "  --frames N                 frames in the sequence (120)\n"
+			<< "  --size W H                 resolution (640 480)\n"
+			<< "  --mesh FILE                .obj mesh\n"
+			<< "  --diffuse FILE, --normal FILE, --gloss FILE, --specular FILE\n"
+			<< "  --spin DEGREES             mesh rotation over the sequence (360)\n"
+			<< "  --orbit RADIUS HEIGHT DEGREES [START]\n"
+			<< "                             camera orbit around the origin over the sequence\n"
+			<< "  --out PREFIX               writes PREFIX_0000.bmp, ... (frame)\n"
+			<< "  --no-output                render only\n"
+			<< "  --contexts K               K renderers on K threads sharing the scene, each renders every Kth frame (1)\n"
+			<< "  --threads N, --pin         job system workers\n";
+	}
+}
+
+bool Offline::RunHeadless(int nrOfFrames, int width, int height, JobSystem* pJobSystem)
+{
+	if (!SceneFiles{}.CanOpen()) return false;
+
+	// fixed step, every run renders the same frames
+	constexpr float rotationPerFrame{ 1.f / 60.f };
+
+	Timer* pTimer{ new Timer{} };
+	Renderer* pRenderer{ new Renderer{ width, height, nullptr, pJobSystem } };
+	pRenderer->SetCameraView({ 0.f, 5.f, -64.f }, 0.f, 0.f); // the view the windowed renderer starts with
+	pTimer->Start();
+
+	std::cout << "Headless, " << width << "x" << height << ", " << nrOfFrames << " frames\n";
+
+	const auto start{ std::chrono::steady_clock::now() };
+	for (int frame{}; frame < nrOfFrames; ++frame)
+	{
+		pRenderer->SetMeshRotation(frame * rotationPerFrame);
+		pRenderer->Update(pTimer);
+		pRenderer->Render();
+		pTimer->Update();
+	}
+	pRenderer->WaitForFrame();
+	const std::chrono::duration<double, std::milli> elapsed{ std::chrono::steady_clock::now() - start };
+
+	std::cout << std::fixed << std::setprecision(3)
+		<< "ms/frame: " << elapsed.count() / std::max(nrOfFrames, 1) << "\n"
+		<< "FPS: " << nrOfFrames * 1000.0 / elapsed.count() << "\n" << std::defaultfloat;
+
+	if (pRenderer->SaveBufferToImage("Rasterizer_Headless.bmp"))
+	{
+		std::cout << "Something went wrong. Frame not saved!\n";
+	}
+	else
+	{
+		std::cout << "Frame saved to Rasterizer_Headless.bmp\n";
+	}
+
+	pTimer->Stop();
+	delete pRenderer;
+	delete pTimer;
+	return true;
+}
+
+bool Offline::ParseBatchSettings(int argc, char* argv[], BatchSettings& settings)
+{
+	for (int argIdx{ 2 }; argIdx < argc; ++argIdx)
+	{
+		const std::string argument{ argv[argIdx] };
+		const int nrOfValues{ argc - 1 - argIdx };
+
+		bool isValid{ true };
+		if (argument == "--frames" && nrOfValues >= 1) isValid = CommandLine::ParseValue(argv[++argIdx], settings.nrOfFrames);
+		else if (argument == "--size" && nrOfValues >= 2)
+		{
+			isValid = CommandLine::ParseValue(argv[++argIdx], settings.width);
+			isValid = CommandLine::ParseValue(argv[++argIdx], settings.height) && isValid;
+		}
+		else if (argument == "--mesh" && nrOfValues >= 1) settings.sceneFiles.mesh = argv[++argIdx];
+		else if (argument == "--diffuse" && nrOfValues >= 1) settings.sceneFiles.diffuse = argv[++argIdx];
+		else if (argument == "--normal" && nrOfValues >= 1) settings.sceneFiles.normalMap = argv[++argIdx];
+		else if (argument == "--gloss" && nrOfValues >= 1) settings.sceneFiles.gloss = argv[++argIdx];
+		else if (argument == "--specular" && nrOfValues >= 1) settings.sceneFiles.specular = argv[++argIdx];
+		else if (argument == "--spin" && nrOfValues >= 1) isValid = CommandLine::ParseValue(argv[++argIdx], settings.meshDegrees);
+		else if (argument == "--orbit" && nrOfValues >= 3)
+		{
+			isValid = CommandLine::ParseValue(argv[++argIdx], settings.orbitRadius);
+			isValid = CommandLine::ParseValue(argv[++argIdx], settings.orbitHeight) && isValid;
+			isValid = CommandLine::ParseValue(argv[++argIdx], settings.orbitDegrees) && isValid;
+			if (argIdx + 1 < argc && argv[argIdx + 1][0] != '-') isValid = CommandLine::ParseValue(argv[++argIdx], settings.orbitStart) && isValid;
+		}
+		else if (argument == "--out" && nrOfValues >= 1) settings.outputPrefix = argv[++argIdx];
+		else if (argument == "--no-output") settings.outputPrefix.clear();
+		else if (argument == "--contexts" && nrOfValues >= 1) isValid = CommandLine::ParseValue(argv[++argIdx], settings.nrOfContexts);
+		else if (argument == "--threads" && nrOfValues >= 1) ++argIdx; // handled by main
+		else if (argument == "--pin") continue;
+		else isValid = false;
+
+		if (!isValid)
+		{
+			std::cout << "Invalid batch option: " << argument << "\n";
+			PrintBatchUsage();
+			return false;
+		}
+	}
+
+	if (settings.nrOfFrames <= 0 || settings.width <= 0 || settings.height <= 0 || settings.nrOfContexts <= 0)
+	{
+		PrintBatchUsage();
+		return false;
+	}
+	return true;
+}
+
+bool Offline::RunBatch(const BatchSettings& settings, JobSystem* pJobSystem)
+{
+	const SceneFiles& files{ settings.sceneFiles };
+	if (!files.CanOpen()) return false;
+
+	// more contexts than frames would sit idle
+	const int nrOfContexts{ std::min(settings.nrOfContexts, settings.nrOfFrames) };
+
+	// one scene, read by every context; a context only has its own camera, targets and render state.
+	// Several contexts parallelize over frames, so each of them renders its frames without the job system
+	const auto loadStart{ std::chrono::steady_clock::now() };
+	Scene* pScene{ new Scene{ files, pJobSystem } };
+	std::vector<Renderer*> pRenderers{};
+	for (int contextIdx{}; contextIdx < nrOfContexts; ++contextIdx)
+	{
+		pRenderers.push_back(new Renderer{ settings.width, settings.height, nullptr, nrOfContexts == 1 ? pJobSystem : nullptr, pScene });
+	}
+	const std::chrono::duration<double, std::milli> loadTime{ std::chrono::steady_clock::now() - loadStart };
+
+	std::cout << "Batch, " << settings.width << "x" << settings.height << ", " << settings.nrOfFrames << " frames, " << nrOfContexts << " context(s)\n";
+
+	std::vector<double> writeTimes(nrOfContexts);
+	const auto start{ std::chrono::steady_clock::now() };
+	if (nrOfContexts == 1)
+	{
+		writeTimes[0] = RenderBatchFrames(*pRenderers[0], settings, 0, 1);
+	}
+	else
+	{
+		std::vector<std::thread> threads{};
+		for (int contextIdx{}; contextIdx < nrOfContexts; ++contextIdx)
+		{
+			threads.emplace_back([&, contextIdx] { writeTimes[contextIdx] = RenderBatchFrames(*pRenderers[contextIdx], settings, contextIdx, nrOfContexts); });
+		}
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+	}
+	const std::chrono::duration<double> elapsed{ std::chrono::steady_clock::now() - start };
+
+	// with several contexts the stages add up the time of every thread
+	StageTimes stageTimes{};
+	double writeTime{};
+	for (int contextIdx{}; contextIdx < nrOfContexts; ++contextIdx)
+	{
+		const StageTimes contextTimes{ pRenderers[contextIdx]->GetStageTimes() };
+		stageTimes.geometry += contextTimes.geometry;
+		stageTimes.clear += contextTimes.clear;
+		stageTimes.raster += contextTimes.raster;
+		stageTimes.resolve += contextTimes.resolve;
+		writeTime += writeTimes[contextIdx];
+	}
+
+	const double msPerFrame{ 1000.0 / settings.nrOfFrames };
+	std::cout << std::fixed << std::setprecision(3)
+		<< "load:        " << loadTime.count() << " ms\n"
+		<< "total:       " << elapsed.count() << " s\n"
+		<< "FPS:         " << settings.nrOfFrames / elapsed.count() << "\n"
+		<< "ms/frame:    " << elapsed.count() * msPerFrame << (nrOfContexts > 1 ? " (stages: thread time summed over contexts)" : "") << "\n"
+		<< "  geometry   " << stageTimes.geometry * msPerFrame << "\n"
+		<< "  clear      " << stageTimes.clear * msPerFrame << "\n"
+		<< "  raster     " << stageTimes.raster * msPerFrame << "\n"
+		<< "  resolve    " << stageTimes.resolve * msPerFrame << "\n"
+		<< "  write      " << writeTime * msPerFrame << "\n"
+		<< "scene:       " << pScene->GetMemoryFootprint() / (1024.0 * 1024.0) << " MB, shared\n"
+		<< "contexts:    " << nrOfContexts << " x " << pRenderers[0]->GetMemoryFootprint() / (1024.0 * 1024.0) << " MB\n"
+		<< "peak memory: " << GetPeakMemoryUsage() / (1024.0 * 1024.0) << " MB\n"
+		<< std::defaultfloat;
+
+	for (Renderer* pRenderer : pRenderers)
+	{
+		delete pRenderer;
+	}
+	delete pScene;
+	return true;
+}
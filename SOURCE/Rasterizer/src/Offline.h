@@ -0,0 +1,51 @@
+#ifndef OFFLINE_H
+#define OFFLINE_H
+
+#include <string>
+#include "Renderer.h"
+
+namespace dae
+{
+	class JobSystem;
+
+	namespace Offline
+	{
+		// Renders nrOfFrames without a window or video subsystem, the mesh turning at a fixed step per frame.
+		// Reports the frame time and saves the last frame as Rasterizer_Headless.bmp.
+		// Returns false if the scene files can't be opened
+		bool RunHeadless(int nrOfFrames, int width, int height, JobSystem* pJobSystem);
+
+		struct BatchSettings
+		{
+			SceneFiles sceneFiles{};
+			int width{ 640 };
+			int height{ 480 };
+			int nrOfFrames{ 120 };
+
+			// turntable: the mesh turns meshDegrees over the whole sequence, 360 loops seamlessly
+			float meshDegrees{ 360.f };
+
+			// camera orbits (0, orbitHeight, 0) at orbitRadius, from orbitStart over orbitDegrees; radius 0 keeps the default view
+			float orbitRadius{};
+			float orbitHeight{ 5.f };
+			float orbitStart{};
+			float orbitDegrees{};
+
+			// independent renderers sharing the scene, each on its own thread rendering every nrOfContexts-th frame
+			int nrOfContexts{ 1 };
+
+			// frames go to <outputPrefix>_0000.bmp, ..., nothing gets written when empty
+			std::string outputPrefix{ "frame" };
+		};
+
+		// options after "--batch", prints the usage and returns false on anything it doesn't understand
+		bool ParseBatchSettings(int argc, char* argv[], BatchSettings& settings);
+
+		// Renders the sequence as fast as possible without a window and writes it as images, on one or several contexts.
+		// Reports frames/second, time per stage and the peak memory of the process.
+		// Returns false if the scene files can't be opened
+		bool RunBatch(const BatchSettings& settings, JobSystem* pJobSystem);
+	}
+}
+
+#endif // !OFFLINE_H
@@ -0,0 +1,273 @@
+//Standard includes
+#include <cassert>
+#ifdef __linux__
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+//Project includes
+#include "PerfCounters.h"
+
+using namespace dae;
+
+namespace
+{
+	// a nested scope would count its stage twice, once in the outer stage as well
+	thread_local bool t_IsInScope{ false };
+}
+
+#ifdef __linux__
+namespace
+{
+	constexpr int NR_OF_COUNTERS{ 5 };
+	constexpr int NR_OF_STAGES{ static_cast<int>(Perf::Stage::Count) };
+
+	// a read gives the counters followed by the time the group was enabled and the time it actually ran
+	constexpr int NR_OF_VALUES{ NR_OF_COUNTERS + 2 };
+	constexpr int TIME_ENABLED{ NR_OF_COUNTERS };
+	constexpr int TIME_RUNNING{ NR_OF_COUNTERS + 1 };
+
+	// the counters, then the scopes and the scaled scopes
+	constexpr int NR_OF_TOTALS{ NR_OF_COUNTERS + 2 };
+	constexpr int NR_OF_SCOPES{ NR_OF_COUNTERS };
+	constexpr int NR_OF_SCALED_SCOPES{ NR_OF_COUNTERS + 1 };
+
+	// in the order of Perf::Counts
+	struct CounterConfig
+	{
+		uint32_t type;
+		uint64_t config;
+	};
+	constexpr CounterConfig COUNTER_CONFIGS[NR_OF_COUNTERS]
+	{
+		{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+		{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+		{ PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+		{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+		{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES }
+	};
+
+	// totals of one thread, kept after it exits; only the owner adds to them
+	struct alignas(64) ThreadTotals
+	{
+		std::atomic<uint64_t> counts[NR_OF_STAGES][NR_OF_TOTALS];
+	};
+
+	std::atomic<bool> g_IsEnabled{ false };
+	std::mutex g_RegistryMutex;
+	std::vector<std::unique_ptr<ThreadTotals>> g_ThreadTotals;
+
+	int OpenCounter(const CounterConfig& counterConfig, int groupFd)
+	{
+		perf_event_attr attributes{};
+		attributes.size = sizeof(attributes);
+		attributes.type = counterConfig.type;
+		attributes.config = counterConfig.config;
+		attributes.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+		attributes.exclude_kernel = 1;
+		attributes.exclude_hv = 1;
+
+		// this thread on any cpu
+		return static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, groupFd, 0));
+	}
+
+	// one counter group per thread, opened on the first scope the thread runs
+	class ThreadGroup final
+	{
+	public:
+		ThreadGroup()
+		{
+			m_LeaderFd = OpenCounter(COUNTER_CONFIGS[0], -1);
+			if (m_LeaderFd < 0) return;
+
+			// counters the cpu or the VM doesn't have stay 0
+			m_CounterSlots[0] = m_NrOfSlots++;
+			for (int counterIdx{ 1 }; counterIdx < NR_OF_COUNTERS; ++counterIdx)
+			{
+				m_MemberFds[counterIdx] = OpenCounter(COUNTER_CONFIGS[counterIdx], m_LeaderFd);
+				if (m_MemberFds[counterIdx] >= 0) m_CounterSlots[counterIdx] = m_NrOfSlots++;
+			}
+
+			{
+				const std::lock_guard lock{ g_RegistryMutex };
+				g_ThreadTotals.push_back(std::make_unique<ThreadTotals>());
+				m_pTotals = g_ThreadTotals.back().get();
+			}
+
+			ioctl(m_LeaderFd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+			ioctl(m_LeaderFd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+		}
+		~ThreadGroup()
+		{
+			for (const int fd : m_MemberFds)
+			{
+				if (fd >= 0) close(fd);
+			}
+			if (m_LeaderFd >= 0) close(m_LeaderFd);
+		}
+
+		ThreadGroup(const ThreadGroup&) = delete;
+		ThreadGroup(ThreadGroup&&) noexcept = delete;
+		ThreadGroup& operator=(const ThreadGroup&) = delete;
+		ThreadGroup& operator=(ThreadGroup&&) noexcept = delete;
+
+		bool IsOpen() const { return m_LeaderFd >= 0; };
+
+		// running totals in the order of Perf::Counts, then the time enabled and running
+		bool Read(uint64_t (&values)[NR_OF_VALUES]) const
+		{
+			uint64_t group[3 + NR_OF_COUNTERS]{}; // nr, time enabled, time running, then one value per opened counter
+			if (read(m_LeaderFd, group, sizeof(group)) < static_cast<ssize_t>(3 * sizeof(uint64_t))) return false;
+
+			for (int counterIdx{}; counterIdx < NR_OF_COUNTERS; ++counterIdx)
+			{
+				values[counterIdx] = m_CounterSlots[counterIdx] >= 0 ? group[3 + m_CounterSlots[counterIdx]] : 0;
+			}
+			values[TIME_ENABLED] = group[1];
+			values[TIME_RUNNING] = group[2];
+			return true;
+		}
+
+		// deltas of one scope
+		void Add(Perf::Stage stage, const uint64_t (&values)[NR_OF_VALUES])
+		{
+			std::atomic<uint64_t> (&totals)[NR_OF_TOTALS]{ m_pTotals->counts[static_cast<int>(stage)] };
+
+			// the whole group is scheduled at once, one ratio covers every counter
+			const uint64_t timeEnabled{ values[TIME_ENABLED] };
+			const uint64_t timeRunning{ values[TIME_RUNNING] };
+			const bool isScaled{ timeRunning < timeEnabled };
+			const double scale{ timeRunning > 0 ? static_cast<double>(timeEnabled) / timeRunning : 0.0 };
+
+			for (int counterIdx{}; counterIdx < NR_OF_COUNTERS; ++counterIdx)
+			{
+				const uint64_t count{ isScaled ? static_cast<uint64_t>(values[counterIdx] * scale + 0.5) : values[counterIdx] };
+				totals[counterIdx].fetch_add(count, std::memory_order_relaxed);
+			}
+			totals[NR_OF_SCOPES].fetch_add(1, std::memory_order_relaxed);
+			if (isScaled) totals[NR_OF_SCALED_SCOPES].fetch_add(1, std::memory_order_relaxed);
+		}
+
+	private:
+		int m_LeaderFd{ -1 };
+		int m_MemberFds[NR_OF_COUNTERS]{ -1, -1, -1, -1, -1 };
+		int m_CounterSlots[NR_OF_COUNTERS]{ -1, -1, -1, -1, -1 };
+		int m_NrOfSlots{};
+		ThreadTotals* m_pTotals{ nullptr };
+	};
+
+	ThreadGroup& GetThreadGroup()
+	{
+		thread_local ThreadGroup threadGroup{};
+		return threadGroup;
+	}
+}
+
+bool Perf::Enable()
+{
+	// the calling thread doubles as the probe
+	if (!GetThreadGroup().IsOpen()) return false;
+
+	g_IsEnabled.store(true, std::memory_order_release);
+	return true;
+}
+
+void Perf::Disable()
+{
+	g_IsEnabled.store(false, std::memory_order_release);
+}
+
+bool Perf::IsEnabled()
+{
+	return g_IsEnabled.load(std::memory_order_acquire);
+}
+
+Perf::Scope::Scope(Stage stage)
+	: m_Stage{ stage },
+	m_IsCounting{ g_IsEnabled.load(std::memory_order_acquire) && GetThreadGroup().IsOpen() },
+	m_Start{}
+{
+	assert(!t_IsInScope && "Perf scopes must not nest");
+	t_IsInScope = true;
+
+	if (m_IsCounting) m_IsCounting = GetThreadGroup().Read(m_Start);
+}
+
+Perf::Scope::~Scope()
+{
+	t_IsInScope = false;
+	if (!m_IsCounting) return;
+
+	uint64_t end[NR_OF_VALUES]{};
+	if (!GetThreadGroup().Read(end)) return;
+
+	for (int valueIdx{}; valueIdx < NR_OF_VALUES; ++valueIdx)
+	{
+		end[valueIdx] -= m_Start[valueIdx];
+	}
+	GetThreadGroup().Add(m_Stage, end);
+}
+
+void Perf::Collect(Counts (&stageCounts)[static_cast<int>(Stage::Count)])
+{
+	uint64_t totals[NR_OF_STAGES][NR_OF_TOTALS]{};
+	{
+		const std::lock_guard lock{ g_RegistryMutex };
+		for (const std::unique_ptr<ThreadTotals>& pThreadTotals : g_ThreadTotals)
+		{
+			for (int stageIdx{}; stageIdx < NR_OF_STAGES; ++stageIdx)
+			{
+				for (int totalIdx{}; totalIdx < NR_OF_TOTALS; ++totalIdx)
+				{
+					totals[stageIdx][totalIdx] += pThreadTotals->counts[stageIdx][totalIdx].exchange(0, std::memory_order_relaxed);
+				}
+			}
+		}
+	}
+
+	for (int stageIdx{}; stageIdx < NR_OF_STAGES; ++stageIdx)
+	{
+		const uint64_t (&stageTotals)[NR_OF_TOTALS]{ totals[stageIdx] };
+		stageCounts[stageIdx] = { stageTotals[0], stageTotals[1], stageTotals[2], stageTotals[3], stageTotals[4], stageTotals[NR_OF_SCOPES], stageTotals[NR_OF_SCALED_SCOPES] };
+	}
+}
+#else
+bool Perf::Enable()
+{
+	return false;
+}
+
+void Perf::Disable()
+{
+}
+
+bool Perf::IsEnabled()
+{
+	return false;
+}
+
+Perf::Scope::Scope(Stage)
+{
+	assert(!t_IsInScope && "Perf scopes must not nest");
+	t_IsInScope = true;
+}
+
+Perf::Scope::~Scope()
+{
+	t_IsInScope = false;
+}
+
+void Perf::Collect(Counts (&stageCounts)[static_cast<int>(Stage::Count)])
+{
+	for (Counts& counts : stageCounts)
+	{
+		counts = {};
+	}
+}
+#endif
@@ -0,0 +1,66 @@
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include <cstdint>
+
+namespace dae
+{
+	// Hardware counters per renderer stage through perf_event_open, summed over every thread that ran the stage.
+	// Linux only, everywhere else Enable fails and the scopes do nothing
+	namespace Perf
+	{
+		enum class Stage
+		{
+			Clear = 0,
+			Vertex,
+			Raster,		// binning, bins and shading, with the job system also the pending clears
+			Resolve,
+			Count
+		};
+
+		struct Counts
+		{
+			uint64_t cycles;
+			uint64_t instructions;
+			uint64_t l1dMisses;		// L1 data read misses
+			uint64_t llcMisses;		// last level cache misses
+			uint64_t branchMisses;
+
+			// with more counters than the PMU has, the kernel time-slices the group; the counts of a scope that
+			// didn't run the whole time are scaled up by enabled / running time, an estimate rather than a count
+			uint64_t nrOfScopes;
+			uint64_t nrOfScaledScopes;
+		};
+
+		// false if the counters can't be opened on this platform or kernel (see /proc/sys/kernel/perf_event_paranoid)
+		bool Enable();
+		void Disable();
+		bool IsEnabled();
+
+		// counts of the calling thread between construction and destruction, scopes must not nest (asserted).
+		// Two syscalls each, so they sit around whole tasks rather than pixels
+		class Scope final
+		{
+		public:
+			explicit Scope(Stage stage);
+			~Scope();
+
+			Scope(const Scope&) = delete;
+			Scope(Scope&&) noexcept = delete;
+			Scope& operator=(const Scope&) = delete;
+			Scope& operator=(Scope&&) noexcept = delete;
+
+#ifdef __linux__
+		private:
+			const Stage m_Stage;
+			bool m_IsCounting;
+			uint64_t m_Start[7]; // the five counters, then the group's time enabled and time running
+#endif
+		};
+
+		// sums and resets the counts of every thread, indexed by Stage
+		void Collect(Counts (&stageCounts)[static_cast<int>(Stage::Count)]);
+	}
+}
+
+#endif // !PERFCOUNTERS_H
@@ -0,0 +1,97 @@
+//Standard includes
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+//Project includes
+#include "PipelineStats.h"
+
+using namespace dae;
+
+#ifdef ENABLE_PIPELINE_STATS
+namespace
+{
+	// counters of every thread that ever added to them, kept after the thread exits so nothing gets lost
+	std::mutex g_RegistryMutex;
+	std::vector<std::unique_ptr<Stats::ThreadCounters>> g_ThreadCounters;
+}
+
+Stats::ThreadCounters* Stats::RegisterThread()
+{
+	const std::lock_guard lock{ g_RegistryMutex };
+	g_ThreadCounters.push_back(std::make_unique<ThreadCounters>());
+	return g_ThreadCounters.back().get();
+}
+#endif
+
+double PipelineStats::GetOverdraw(int nrOfFrames, int nrOfPixels) const
+{
+	return static_cast<double>(pixelsShaded) / (static_cast<double>(nrOfFrames) * nrOfPixels);
+}
+
+PipelineStats Stats::Collect()
+{
+	PipelineStats stats{};
+
+#ifdef ENABLE_PIPELINE_STATS
+	uint64_t counters[static_cast<int>(Counter::Count)]{};
+	int64_t stageNanoseconds[static_cast<int>(Stage::Count)]{};
+	{
+		const std::lock_guard lock{ g_RegistryMutex };
+		for (const std::unique_ptr<ThreadCounters>& pThreadCounters : g_ThreadCounters)
+		{
+			for (int counterIdx{}; counterIdx < static_cast<int>(Counter::Count); ++counterIdx)
+			{
+				counters[counterIdx] += pThreadCounters->counters[counterIdx].exchange(0, std::memory_order_relaxed);
+			}
+			for (int stageIdx{}; stageIdx < static_cast<int>(Stage::Count); ++stageIdx)
+			{
+				stageNanoseconds[stageIdx] += pThreadCounters->stageNanoseconds[stageIdx].exchange(0, std::memory_order_relaxed);
+			}
+		}
+	}
+
+	stats.verticesTransformed = counters[static_cast<int>(Counter::VerticesTransformed)];
+	stats.trianglesSubmitted = counters[static_cast<int>(Counter::TrianglesSubmitted)];
+	stats.trianglesCulled = counters[static_cast<int>(Counter::TrianglesCulled)];
+	stats.trianglesClipped = counters[static_cast<int>(Counter::TrianglesClipped)];
+	stats.trianglesRasterized = stats.trianglesSubmitted - stats.trianglesCulled - stats.trianglesClipped;
+	stats.pixelsTested = counters[static_cast<int>(Counter::PixelsTested)];
+	stats.pixelsDepthPassed = counters[static_cast<int>(Counter::PixelsDepthPassed)];
+	stats.pixelsShaded = counters[static_cast<int>(Counter::PixelsShaded)];
+
+	stats.clearTime = stageNanoseconds[static_cast<int>(Stage::Clear)] * 1e-9;
+	stats.vertexTime = stageNanoseconds[static_cast<int>(Stage::Vertex)] * 1e-9;
+	stats.rasterTime = stageNanoseconds[static_cast<int>(Stage::Raster)] * 1e-9;
+	stats.shadingTime = stageNanoseconds[static_cast<int>(Stage::Shading)] * 1e-9;
+	stats.presentTime = stageNanoseconds[static_cast<int>(Stage::Present)] * 1e-9;
+#endif
+
+	return stats;
+}
+
+void Stats::Print(const PipelineStats& stats, int nrOfFrames, int nrOfPixels)
+{
+	if (nrOfFrames <= 0) return;
+
+	const auto perFrame{ [nrOfFrames](uint64_t count) { return count / static_cast<uint64_t>(nrOfFrames); } };
+	const auto msPerFrame{ [nrOfFrames](double seconds) { return seconds * 1000.0 / nrOfFrames; } };
+
+	std::cout << std::fixed << std::setprecision(3)
+		<< "Pipeline per frame (" << nrOfFrames << " frames)\n"
+		<< "  vertices   " << perFrame(stats.verticesTransformed) << " transformed\n"
+		<< "  triangles  " << perFrame(stats.trianglesSubmitted) << " submitted, "
+		<< perFrame(stats.trianglesCulled) << " culled, "
+		<< perFrame(stats.trianglesClipped) << " clipped, "
+		<< perFrame(stats.trianglesRasterized) << " rasterized\n"
+		<< "  pixels     " << perFrame(stats.pixelsTested) << " tested, "
+		<< perFrame(stats.pixelsDepthPassed) << " depth passed, "
+		<< perFrame(stats.pixelsShaded) << " shaded, overdraw " << stats.GetOverdraw(nrOfFrames, nrOfPixels) << "\n"
+		<< "  ms         clear " << msPerFrame(stats.clearTime)
+		<< ", vertex " << msPerFrame(stats.vertexTime)
+		<< ", raster " << msPerFrame(stats.rasterTime)
+		<< " (shading " << msPerFrame(stats.shadingTime) << ")"
+		<< ", present " << msPerFrame(stats.presentTime) << "\n";
+}
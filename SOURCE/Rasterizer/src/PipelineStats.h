@@ -0,0 +1,129 @@
+#ifndef PIPELINESTATS_H
+#define PIPELINESTATS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// D3D style pipeline statistics and stage timers, compiled out unless defined here or by the build, the Profile|x64
+// configuration defines it
+//#define ENABLE_PIPELINE_STATS
+
+namespace dae
+{
+	// counts and times summed over every thread since the last Stats::Collect
+	struct PipelineStats
+	{
+		uint64_t verticesTransformed;
+		uint64_t trianglesSubmitted;
+		uint64_t trianglesCulled;		// entirely outside the screen or without area
+		uint64_t trianglesClipped;		// crossing the screen border, there is no clipper so these get dropped too
+		uint64_t trianglesRasterized;	// submitted - culled - clipped
+		uint64_t pixelsTested;			// inside a triangle, tested against the depth range and the depth buffer
+		uint64_t pixelsDepthPassed;
+		uint64_t pixelsShaded;
+
+		// seconds of CPU time summed over the threads that ran the stage, shading is part of raster
+		double clearTime;
+		double vertexTime;
+		double rasterTime;
+		double shadingTime;
+		double presentTime;
+
+		// times a screen pixel got shaded on average
+		double GetOverdraw(int nrOfFrames, int nrOfPixels) const;
+	};
+
+	namespace Stats
+	{
+#ifdef ENABLE_PIPELINE_STATS
+		constexpr bool IS_ENABLED{ true };
+#else
+		constexpr bool IS_ENABLED{ false };
+#endif
+
+		enum class Counter
+		{
+			VerticesTransformed = 0,
+			TrianglesSubmitted,
+			TrianglesCulled,
+			TrianglesClipped,
+			PixelsTested,
+			PixelsDepthPassed,
+			PixelsShaded,
+			Count
+		};
+
+		enum class Stage
+		{
+			Clear = 0,
+			Vertex,
+			Raster,
+			Shading,
+			Present,
+			Count
+		};
+
+#ifdef ENABLE_PIPELINE_STATS
+		// one per thread on its own cache line, only the owner adds to it so the atomics never contend
+		struct alignas(64) ThreadCounters
+		{
+			std::atomic<uint64_t> counters[static_cast<int>(Counter::Count)];
+			std::atomic<int64_t> stageNanoseconds[static_cast<int>(Stage::Count)];
+		};
+
+		ThreadCounters* RegisterThread();
+		inline thread_local ThreadCounters* t_pThreadCounters{ nullptr };
+
+		inline ThreadCounters& GetThreadCounters()
+		{
+			if (!t_pThreadCounters) t_pThreadCounters = RegisterThread();
+			return *t_pThreadCounters;
+		}
+
+		inline void Add(Counter counter, uint64_t value)
+		{
+			GetThreadCounters().counters[static_cast<int>(counter)].fetch_add(value, std::memory_order_relaxed);
+		}
+
+		class ScopedTimer final
+		{
+		public:
+			explicit ScopedTimer(Stage stage)
+				: m_Stage{ stage }, m_Start{ std::chrono::steady_clock::now() }
+			{
+			}
+			~ScopedTimer()
+			{
+				const std::chrono::nanoseconds elapsed{ std::chrono::steady_clock::now() - m_Start };
+				GetThreadCounters().stageNanoseconds[static_cast<int>(m_Stage)].fetch_add(elapsed.count(), std::memory_order_relaxed);
+			}
+
+			ScopedTimer(const ScopedTimer&) = delete;
+			ScopedTimer(ScopedTimer&&) noexcept = delete;
+			ScopedTimer& operator=(const ScopedTimer&) = delete;
+			ScopedTimer& operator=(ScopedTimer&&) noexcept = delete;
+
+		private:
+			const Stage m_Stage;
+			const std::chrono::steady_clock::time_point m_Start;
+		};
+#else
+		inline void Add(Counter, uint64_t) {}
+
+		class ScopedTimer final
+		{
+		public:
+			explicit ScopedTimer(Stage) {}
+		};
+#endif
+
+		// sums and resets the counters of every thread, all zero when compiled out
+		PipelineStats Collect();
+
+		// per frame averages of stats collected over nrOfFrames frames
+		void Print(const PipelineStats& stats, int nrOfFrames, int nrOfPixels);
+	}
+}
+
+#endif // !PIPELINESTATS_H
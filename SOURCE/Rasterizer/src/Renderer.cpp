@@ -1,6 +1,14 @@
 ﻿
 //External includes
+#include <chrono>
+#include <cmath>
 #include <iostream>
+#include <new>
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
 #include "SDL.h"
 #include "SDL_surface.h"
 
@@ -8,13 +16,100 @@
 #include "Renderer.h"
 #include "Maths.h"
 #include "Texture.h"
-#include "Utils.h"
 #include "BRDFs.h"
+#include "ColorOutput.h"
+#include "JobSystem.h"
+#include "AllocationTracker.h"
+#include "PerfCounters.h"
+#include "PipelineStats.h"
+#include "Trace.h"
 
 using namespace dae;
 
-Renderer::Renderer(SDL_Window* pWindow, int width, int height) 
+namespace
+{
+	// cache line aligned buffers, an 8x8 tile of 32-bit values then covers exactly 4 lines
+	template<typename T>
+	T* AllocateAligned(int count)
+	{
+		return static_cast<T*>(::operator new[](count * sizeof(T), std::align_val_t{ 64 }));
+	}
+
+	template<typename T>
+	void FreeAligned(T* pBuffer)
+	{
+		::operator delete[](pBuffer, std::align_val_t{ 64 });
+	}
+
+	// adds the cycles of its lifetime, or up to Stop, to *pCycles, does nothing without one
+	class ScopedCycles final
+	{
+	public:
+		explicit ScopedCycles(uint32_t* pCycles)
+			: m_pCycles{ pCycles }, m_Start{ pCycles ? __rdtsc() : 0 }
+		{
+		}
+		~ScopedCycles()
+		{
+			Stop();
+		}
+
+		void Stop()
+		{
+			if (m_pCycles) *m_pCycles += static_cast<uint32_t>(__rdtsc() - m_Start);
+			m_pCycles = nullptr;
+		}
+
+		ScopedCycles(const ScopedCycles&) = delete;
+		ScopedCycles(ScopedCycles&&) noexcept = delete;
+		ScopedCycles& operator=(const ScopedCycles&) = delete;
+		ScopedCycles& operator=(ScopedCycles&&) noexcept = delete;
+
+	private:
+		uint32_t* m_pCycles;
+		const uint64_t m_Start;
+	};
+
+	// blue -> cyan -> green -> yellow -> red over [0, 1]
+	ColorRGB GetHeatColor(float heat)
+	{
+		const float scaledHeat{ std::clamp(heat, 0.f, 1.f) * 4.f };
+		const int segment{ std::min(static_cast<int>(scaledHeat), 3) };
+		const float blend{ scaledHeat - segment };
+
+		switch (segment)
+		{
+		case 0:
+			return { 0.f, blend, 1.f };
+		case 1:
+			return { 0.f, 1.f, 1.f - blend };
+		case 2:
+			return { blend, 1.f, 0.f };
+		default:
+			return { 1.f, 1.f - blend, 0.f };
+		}
+	}
+
+	// allocates or frees pBuffer so it only exists while needed
+	template<typename T>
+	void UpdateAllocation(T*& pBuffer, bool isNeeded, int count)
+	{
+		if (isNeeded && !pBuffer)
+		{
+			pBuffer = AllocateAligned<T>(count);
+		}
+		else if (!isNeeded && pBuffer)
+		{
+			FreeAligned(pBuffer);
+			pBuffer = nullptr;
+		}
+	}
+}
+
+Renderer::Renderer(SDL_Window* pWindow, int width, int height, JobSystem* pJobSystem, const Scene* pScene) 
 	: m_pWindow{ pWindow }, 
+	m_pScene{ pScene },
+	m_pJobSystem{ pJobSystem },
 	m_Width{ width }, 
 	m_Height{ height }, 
 	m_NrOfPixels{ width * height }
@@ -22,110 +117,585 @@ Renderer::Renderer(SDL_Window* pWindow, int width, int height)
 	//Create Buffers
 	m_pFrontBuffer = SDL_GetWindowSurface(pWindow);
 	m_pBackBuffer = SDL_CreateRGBSurface(0, m_Width, m_Height, 32, 0, 0, 0, 0);
-	m_pBackBufferPixels = (uint32_t*)m_pBackBuffer->pixels;
+
+	// the window surface can be rendered to directly if it has exactly the backbuffer's layout
+	m_CanPresentDirect =
+		m_pFrontBuffer->format->format == m_pBackBuffer->format->format &&
+		m_pFrontBuffer->w == m_Width && m_pFrontBuffer->h == m_Height &&
+		m_pFrontBuffer->pitch == m_pBackBuffer->pitch;
+
+	Initialize();
+}
+
+Renderer::Renderer(int width, int height, uint32_t* pPixels, JobSystem* pJobSystem, const Scene* pScene)
+	: m_pWindow{ nullptr },
+	m_pScene{ pScene },
+	m_pJobSystem{ pJobSystem },
+	m_Width{ width },
+	m_Height{ height },
+	m_NrOfPixels{ width * height }
+{
+	// headless, no video subsystem: the frame stays in the backbuffer, which wraps the caller's pixels if there are any
+	m_pFrontBuffer = nullptr;
+	m_pBackBuffer = pPixels ?
+		SDL_CreateRGBSurfaceFrom(pPixels, m_Width, m_Height, 32, m_Width * static_cast<int>(sizeof(uint32_t)), 0, 0, 0, 0) :
+		SDL_CreateRGBSurface(0, m_Width, m_Height, 32, 0, 0, 0, 0);
+	m_CanPresentDirect = false;
+
+	// nothing to read input from, the camera is placed with SetCameraView / SetCameraLookAt
+	m_CameraInput = false;
+
+	Initialize();
+}
+
+void Renderer::Initialize()
+{
+	// tiles, buffers are padded so the tiled layout always holds whole tiles
+	m_NrOfTilesX = (m_Width + TILE_SIZE - 1) / TILE_SIZE;
+	m_NrOfTilesY = (m_Height + TILE_SIZE - 1) / TILE_SIZE;
+	m_NrOfBufferPixels = m_NrOfTilesX * m_NrOfTilesY * TILE_SIZE * TILE_SIZE;
+
+	m_pColorOutput = new ColorOutput{ m_pBackBuffer->format };
+	m_pPresenter = nullptr;
+	m_pFrameWorker = nullptr;
+
+	// depth buffer of the current format, the tiled and HDR targets only once they get enabled
+	m_pDepthBufferPixels = nullptr;
+	m_pDepth24BufferPixels = nullptr;
+	m_pDepth16BufferPixels = nullptr;
+	m_pTiledColorPixels = nullptr;
+	m_pHDRBufferPixels = nullptr;
+	m_pHeatmapPixels = nullptr;
+	UpdateTargetAllocations();
 
 	// make / fill depthBuffer with FLT_MAX values
-	m_pDepthBufferPixels = new float[m_Width * m_Height];
-	std::fill_n(m_pDepthBufferPixels, m_NrOfPixels, FLT_MAX);
+	ClearDepth(0, m_NrOfBufferPixels);
+
+	// tile flags, every tile starts out waiting for its first clear
+	m_pTileFlags = new uint8_t[m_NrOfTilesX * m_NrOfTilesY];
+	SelectRenderTarget();
 
 	// set every pixel to black
 	std::fill_n(m_pBackBufferPixels, m_NrOfPixels, uint32_t(0));
 
+	m_ClearColor = SDL_MapRGB(m_pBackBuffer->format, 100, 100, 100);
+	uint8_t clearRed{}, clearGreen{}, clearBlue{};
+	SDL_GetRGB(m_ClearColor, m_pBackBuffer->format, &clearRed, &clearGreen, &clearBlue);
+	m_HDRClearColor = { clearRed / 255.f, clearGreen / 255.f, clearBlue / 255.f };
+
 	//Initialize Camera
-	m_Camera.Initialize(45.f, { 0.f, 5.f, -64.f }, width / (float)height);
+	m_Camera.Initialize(45.f, { 0.f, 5.f, -64.f }, m_Width / (float)m_Height);
 
 	CreateScene();
+
+	// bins for the parallel raster, one list per bin for every chunk of triangles
+	m_pFrameGraph = new TaskGraph{};
+	m_NrOfBinsX = (m_Width + BIN_SIZE - 1) / BIN_SIZE;
+	m_NrOfBinsY = (m_Height + BIN_SIZE - 1) / BIN_SIZE;
+	const int nrOfTriangles{ static_cast<int>(m_pScene->GetMesh().indices.size() / 3) };
+	m_NrOfBinningChunks = std::max((nrOfTriangles + BINNING_GRAIN - 1) / BINNING_GRAIN, 1);
+	m_pBinnedTriangles = new std::vector<uint32_t>[m_NrOfBinningChunks * m_NrOfBinsX * m_NrOfBinsY];
 }
 
 Renderer::~Renderer()
 {
+	// frame in flight
+	if (m_pFrameWorker) delete m_pFrameWorker;
+
+	// parallel raster
+	if (m_pFrameGraph) delete m_pFrameGraph;
+	if (m_pBinnedTriangles) delete[] m_pBinnedTriangles;
+
+	// present thread, finishes the frames still queued
+	if (m_pPresenter) delete m_pPresenter;
+
 	// depthBuffer
-	if (m_pDepthBufferPixels) delete[] m_pDepthBufferPixels;
+	if (m_pDepthBufferPixels) FreeAligned(m_pDepthBufferPixels);
+	if (m_pDepth24BufferPixels) FreeAligned(m_pDepth24BufferPixels);
+	if (m_pDepth16BufferPixels) FreeAligned(m_pDepth16BufferPixels);
+
+	// tiled color
+	if (m_pTiledColorPixels) FreeAligned(m_pTiledColorPixels);
+
+	// HDR target
+	if (m_pHDRBufferPixels) FreeAligned(m_pHDRBufferPixels);
+
+	// heatmap
+	if (m_pHeatmapPixels) FreeAligned(m_pHeatmapPixels);
 
-	// textures
-	if (m_pDiffuseTexture) delete m_pDiffuseTexture;
-	if (m_pNormalMapTexture) delete m_pNormalMapTexture;
-	if (m_pGlossTexture) delete m_pGlossTexture;
-	if (m_pSpecularTexture) delete m_pSpecularTexture;
+	// tile flags
+	if (m_pTileFlags) delete[] m_pTileFlags;
+
+	// color output
+	if (m_pColorOutput) delete m_pColorOutput;
+
+	// backbuffer, the window surface belongs to the window
+	if (m_pBackBuffer) SDL_FreeSurface(m_pBackBuffer);
+
+	// scene, unless it is shared
+	if (m_pOwnedScene) delete m_pOwnedScene;
 }
 
 void dae::Renderer::CreateScene()
 {
-	// create mesh
-	m_TriangleListMesh.primitiveTopology = PrimitiveTopology::TriangleList;
-	Utils::ParseOBJ("Resources/vehicle.obj", m_TriangleListMesh.vertices, m_TriangleListMesh.indices);
+	// load the default scene if none is shared with this renderer
+	m_pOwnedScene = m_pScene ? nullptr : new Scene{ SceneFiles{}, m_pJobSystem };
+	if (m_pOwnedScene) m_pScene = m_pOwnedScene;
+
 	m_MeshTranslationMatrix = Matrix::CreateTranslation(0.f, 0.f, 0.f);
 	m_MeshRotationMatrix = Matrix::CreateRotation(0.f, 0.f, 0.f);
-	m_TriangleListMesh.worldMatrix = m_MeshRotationMatrix * m_MeshTranslationMatrix;
+	m_WorldMatrix = m_MeshRotationMatrix * m_MeshTranslationMatrix;
 
-	// Textures
-	m_pDiffuseTexture = Texture::LoadFromFile("Resources/vehicle_diffuse.png");
-	m_pNormalMapTexture = Texture::LoadFromFile("Resources/vehicle_normal.png");
-	m_pGlossTexture = Texture::LoadFromFile("Resources/vehicle_gloss.png");
-	m_pSpecularTexture = Texture::LoadFromFile("Resources/vehicle_specular.png");
-
-	// check textures
-	assert(m_pDiffuseTexture != nullptr);
-	assert(m_pNormalMapTexture != nullptr);
-	assert(m_pGlossTexture != nullptr);
-	assert(m_pSpecularTexture != nullptr);
+	m_pDiffuseTexture = m_pScene->GetDiffuseTexture();
+	m_pNormalMapTexture = m_pScene->GetNormalMapTexture();
+	m_pGlossTexture = m_pScene->GetGlossTexture();
+	m_pSpecularTexture = m_pScene->GetSpecularTexture();
 }
 
 void Renderer::Update(Timer* pTimer)
 {
-	m_Camera.Update(pTimer);
+	const Trace::Zone updateZone{ "Update" };
+	const Allocations::Scope updateAllocations{ Allocations::Stage::Update };
 
-	std::fill_n(m_pDepthBufferPixels, m_NrOfPixels, FLT_MAX);
-	SDL_FillRect(m_pBackBuffer, NULL, SDL_MapRGB(m_pBackBuffer->format, 100, 100, 100));
+	if (m_CameraInput) m_Camera.Update(pTimer);
 
 	if (m_MeshRotating)
 	{
 		m_MeshRotateAngle += pTimer->GetElapsed();
 		m_MeshRotationMatrix = Matrix::CreateRotation(0.f, m_MeshRotateAngle, 0.f);
-		m_TriangleListMesh.worldMatrix = m_MeshRotationMatrix * m_MeshTranslationMatrix;
+		m_WorldMatrix = m_MeshRotationMatrix * m_MeshTranslationMatrix;
+	}
+
+	// snapshot, the geometry stage only reads these
+	const Matrix worldViewMatrix{ m_WorldMatrix * m_Camera.viewMatrix };
+	m_FrameConstants.worldMatrix = m_WorldMatrix;
+	m_FrameConstants.worldViewProjectionMatrix = worldViewMatrix * m_Camera.projectionMatrix;
+	m_FrameConstants.positionMatrix = m_DepthFormat == DepthFormat::ReversedFloat32 ?
+		worldViewMatrix * m_Camera.reversedZProjectionMatrix :
+		m_FrameConstants.worldViewProjectionMatrix;
+
+	// with pipelined frames this overlaps the raster of the previous frame
+	const auto geometryStart{ std::chrono::steady_clock::now() };
+	{
+		const Trace::Zone geometryZone{ "Geometry" };
+		VertexTransformationFunction(m_pScene->GetMesh().vertices, m_NextVerticesOut);
+	}
+	const auto geometryEnd{ std::chrono::steady_clock::now() };
+
+	// the previous frame has to be done with vertices_out and the targets from here on
+	WaitForFrame();
+
+	// the frame worker only blits, the window gets updated from the thread that created it
+	if (m_pFrameWorker && m_pWindow && !m_pPresenter) SDL_UpdateWindowSurface(m_pWindow);
+
+	m_StageTimes.geometry += std::chrono::duration<double>(geometryEnd - geometryStart).count();
+
+	if (m_pFrameWorker)
+	{
+		const auto overlapStart{ std::max(geometryStart, m_pFrameWorker->GetJobStart()) };
+		const auto overlapEnd{ std::min(geometryEnd, m_pFrameWorker->GetJobEnd()) };
+
+		m_GeometryTime += std::chrono::duration<double>(geometryEnd - geometryStart).count();
+		if (overlapEnd > overlapStart) m_OverlappedGeometryTime += std::chrono::duration<double>(overlapEnd - overlapStart).count();
 	}
 
-	VertexTransformationFunction(m_TriangleListMesh.vertices, m_TriangleListMesh.vertices_out);
+	std::swap(m_VerticesOut, m_NextVerticesOut);
+
+	// with the async present every frame goes into the next free frame of the ring
+	if (m_pPresenter) SetRenderTarget(m_pPresenter->AcquireFrame());
+
+	const auto clearStart{ std::chrono::steady_clock::now() };
+	ClearBuffers();
+	m_StageTimes.clear += std::chrono::duration<double>(std::chrono::steady_clock::now() - clearStart).count();
 }
 
 void Renderer::Render() const
 {
+	if (m_pFrameWorker)
+	{
+		// rasterized on the worker, the next Update runs its geometry stage in the meantime
+		m_pFrameWorker->Submit([this] { RenderFrame(); });
+		return;
+	}
+
+	RenderFrame();
+}
+
+void Renderer::WaitForFrame() const
+{
+	if (m_pFrameWorker) m_pFrameWorker->Wait();
+}
+
+void Renderer::WaitForPresent() const
+{
+	WaitForFrame();
+	if (m_pPresenter) m_pPresenter->WaitUntilIdle();
+}
+
+void Renderer::RenderFrame() const
+{
+	const Trace::Zone frameZone{ "RenderFrame" };
+	const Allocations::Scope frameAllocations{ Allocations::Stage::Raster };
+
 	//Lock BackBuffer
-	SDL_LockSurface(m_pBackBuffer);
+	SDL_LockSurface(m_pRenderTarget);
+
+	const auto rasterStart{ std::chrono::steady_clock::now() };
+	if (m_pJobSystem && m_UseJobSystem)
+	{
+		// binning, raster, pending clears and resolve as one task graph
+		RenderListMeshParallel();
+		m_StageTimes.raster += std::chrono::duration<double>(std::chrono::steady_clock::now() - rasterStart).count();
+	}
+	else
+	{
+		// render the mesh
+		RenderListMesh(m_pScene->GetMesh(), m_VerticesOut);
+		const auto resolveStart{ std::chrono::steady_clock::now() };
+		m_StageTimes.raster += std::chrono::duration<double>(resolveStart - rasterStart).count();
+		const Trace::Zone resolveZone{ "Resolve" };
+		const Perf::Scope resolveCounters{ Perf::Stage::Resolve };
+		const Allocations::Scope resolveAllocations{ Allocations::Stage::Resolve };
+
+		// tiles nothing was drawn to still need their clear color
+		if (m_LazyClear) ResolvePendingClears();
+
+		// tonemap the float target into the backbuffer, or bring tiled color back to scanlines
+		if (m_HDRTarget)
+		{
+			ResolveHDRBuffer();
+		}
+		else if (m_TiledLayout)
+		{
+			DetileColorBuffer();
+		}
+		m_StageTimes.resolve += std::chrono::duration<double>(std::chrono::steady_clock::now() - resolveStart).count();
+	}
 
-	// render the mesh
-	RenderListMesh(m_TriangleListMesh);
+	// debug view on top of the finished frame
+	if (m_HeatmapMode != HeatmapMode::off) ResolveHeatmap();
 
 	//Update SDL Surface
-	SDL_UnlockSurface(m_pBackBuffer);
-	SDL_BlitSurface(m_pBackBuffer, 0, m_pFrontBuffer, 0);
-	SDL_UpdateWindowSurface(m_pWindow);
+	SDL_UnlockSurface(m_pRenderTarget);
+	if (m_pPresenter)
+	{
+		// the blit happens on the present thread, the window update on the main thread
+		const Stats::ScopedTimer presentTimer{ Stats::Stage::Present };
+		const Trace::Zone presentZone{ "Present" };
+		const Allocations::Scope presentAllocations{ Allocations::Stage::Present };
+		m_pPresenter->SubmitFrame(m_pRenderTarget);
+		return;
+	}
+
+	// headless, the caller reads the frame from the target
+	if (!m_pWindow) return;
+
+	const Stats::ScopedTimer presentTimer{ Stats::Stage::Present };
+	const Trace::Zone presentZone{ "Present" };
+	const Allocations::Scope presentAllocations{ Allocations::Stage::Present };
+	if (m_pRenderTarget != m_pFrontBuffer) SDL_BlitSurface(m_pBackBuffer, 0, m_pFrontBuffer, 0);
+
+	// on the frame worker, Update shows it after waiting for the frame
+	if (!m_pFrameWorker) SDL_UpdateWindowSurface(m_pWindow);
+}
+
+
+void Renderer::ClearBuffers()
+{
+	const Stats::ScopedTimer clearTimer{ Stats::Stage::Clear };
+	const Trace::Zone clearZone{ "Clear" };
+	const Perf::Scope clearCounters{ Perf::Stage::Clear };
+	const Allocations::Scope clearAllocations{ Allocations::Stage::Clear };
+
+	if (m_pHeatmapPixels) std::fill_n(m_pHeatmapPixels, m_NrOfBufferPixels, 0u);
+
+	if (m_LazyClear)
+	{
+		// O(tiles): the actual values get written when a tile is first touched or at present
+		const int nrOfTiles{ m_NrOfTilesX * m_NrOfTilesY };
+		for (int tileIdx{}; tileIdx < nrOfTiles; ++tileIdx)
+		{
+			uint8_t& flags{ m_pTileFlags[tileIdx] };
+			flags |= tilePendingDepth;
+			if (!(flags & tileColorIsClear)) flags |= tilePendingColor;
+		}
+		return;
+	}
+
+	ClearDepth(0, m_NrOfBufferPixels);
+	if (m_HDRTarget)
+	{
+		ClearHDRColor(0, m_NrOfBufferPixels);
+	}
+	else if (m_TiledLayout)
+	{
+		std::fill_n(m_pTiledColorPixels, m_NrOfBufferPixels, m_ClearColor);
+	}
+	else
+	{
+		SDL_FillRect(m_pRenderTarget, NULL, m_ClearColor);
+	}
+}
+
+void dae::Renderer::PrepareTiles(int xMin, int yMin, int xMax, int yMax) const
+{
+	if (xMin >= xMax || yMin >= yMax) return;
+
+	const int tileXMin{ xMin / TILE_SIZE };
+	const int tileYMin{ yMin / TILE_SIZE };
+	const int tileXMax{ (xMax - 1) / TILE_SIZE };
+	const int tileYMax{ (yMax - 1) / TILE_SIZE };
+
+	for (int tileY{ tileYMin }; tileY <= tileYMax; ++tileY)
+	{
+		for (int tileX{ tileXMin }; tileX <= tileXMax; ++tileX)
+		{
+			uint8_t& flags{ m_pTileFlags[tileX + tileY * m_NrOfTilesX] };
+			if (flags & (tilePendingDepth | tilePendingColor)) ClearTile(tileX, tileY, flags);
+
+			// about to be drawn to, color no longer known to be clear
+			flags = 0;
+		}
+	}
+}
+
+void dae::Renderer::ClearTile(int tileX, int tileY, uint8_t clearFlags) const
+{
+	if (m_TiledLayout)
+	{
+		// the whole tile is one contiguous block
+		constexpr int nrOfTilePixels{ TILE_SIZE * TILE_SIZE };
+		const int tileStart{ (tileX + tileY * m_NrOfTilesX) * nrOfTilePixels };
+
+		if (clearFlags & tilePendingDepth)
+		{
+			ClearDepth(tileStart, nrOfTilePixels);
+		}
+
+		if (clearFlags & tilePendingColor)
+		{
+			if (m_HDRTarget)
+			{
+				ClearHDRColor(tileStart, nrOfTilePixels);
+			}
+			else
+			{
+				std::fill_n(m_pTiledColorPixels + tileStart, nrOfTilePixels, m_ClearColor);
+			}
+		}
+		return;
+	}
+
+	const int xMin{ tileX * TILE_SIZE };
+	const int yMin{ tileY * TILE_SIZE };
+	const int tileWidth{ std::min(TILE_SIZE, m_Width - xMin) };
+	const int yMax{ std::min(yMin + TILE_SIZE, m_Height) };
+
+	for (int py{ yMin }; py < yMax; ++py)
+	{
+		const int rowStart{ xMin + py * m_Width };
+
+		if (clearFlags & tilePendingDepth)
+		{
+			ClearDepth(rowStart, tileWidth);
+		}
+
+		if (clearFlags & tilePendingColor)
+		{
+			if (m_HDRTarget)
+			{
+				ClearHDRColor(rowStart, tileWidth);
+			}
+			else
+			{
+				std::fill_n(m_pBackBufferPixels + rowStart, tileWidth, m_ClearColor);
+			}
+		}
+	}
 }
 
+void dae::Renderer::ResolvePendingClears() const
+{
+	ResolvePendingClears(0, 0, m_NrOfTilesX, m_NrOfTilesY);
+}
+
+void dae::Renderer::ResolvePendingClears(int tileXMin, int tileYMin, int tileXMax, int tileYMax) const
+{
+	const Stats::ScopedTimer clearTimer{ Stats::Stage::Clear };
+
+	for (int tileY{ tileYMin }; tileY < tileYMax; ++tileY)
+	{
+		for (int tileX{ tileXMin }; tileX < tileXMax; ++tileX)
+		{
+			uint8_t& flags{ m_pTileFlags[tileX + tileY * m_NrOfTilesX] };
+			if (!(flags & tilePendingColor)) continue;
+
+			ClearTile(tileX, tileY, tilePendingColor);
+			flags = (flags & ~tilePendingColor) | tileColorIsClear;
+		}
+	}
+}
 
-void dae::Renderer::RenderListMesh(const Mesh& listMesh) const
+void dae::Renderer::RenderListMesh(const Mesh& listMesh, const std::vector<Vertex_Out>& vertices_out) const
 {
 	constexpr size_t nrTrianglePoints{ 3 };
 	const std::vector<uint32_t>& indices{ listMesh.indices };
 	assert(indices.size() % 3 == 0);
 
+	const Stats::ScopedTimer rasterTimer{ Stats::Stage::Raster };
+	const Trace::Zone rasterZone{ "Raster" };
+	const Perf::Scope rasterCounters{ Perf::Stage::Raster };
+	Stats::Add(Stats::Counter::TrianglesSubmitted, indices.size() / nrTrianglePoints);
+
 	for (size_t index{}; index < indices.size(); index += nrTrianglePoints)
 	{
 		// store vertices in local variables
-		const Vertex_Out& vertex0{ listMesh.vertices_out[indices[index]] };
-		const Vertex_Out& vertex1{ listMesh.vertices_out[indices[index + 1]] };
-		const Vertex_Out& vertex2{ listMesh.vertices_out[indices[index + 2]] };
+		const Vertex_Out& vertex0{ vertices_out[indices[index]] };
+		const Vertex_Out& vertex1{ vertices_out[indices[index + 1]] };
+		const Vertex_Out& vertex2{ vertices_out[indices[index + 2]] };
 
 		// render triangle with current vertices
 		RenderTriangle(vertex0, vertex1, vertex2);
 	}
 }
 
-void dae::Renderer::RenderStripMesh(const Mesh& stripMesh) const
+void dae::Renderer::RenderListMeshParallel() const
+{
+	TaskGraph& graph{ *m_pFrameGraph };
+	graph.Clear();
+
+	// binning chunks -> barrier -> every bin -> resolve of the bin rows
+	const int binningDone{ graph.AddTask([] {}) };
+	for (int chunkIdx{}; chunkIdx < m_NrOfBinningChunks; ++chunkIdx)
+	{
+		const int binningTask{ graph.AddTask([this, chunkIdx] { BinTriangles(chunkIdx); }) };
+		graph.AddDependency(binningDone, binningTask);
+	}
+
+	const bool needsResolve{ m_HDRTarget || m_TiledLayout };
+	for (int binY{}; binY < m_NrOfBinsY; ++binY)
+	{
+		const int resolveTask{ needsResolve ? graph.AddTask([this, binY] { ResolveBinRow(binY); }) : -1 };
+
+		for (int binX{}; binX < m_NrOfBinsX; ++binX)
+		{
+			const int binIdx{ binX + binY * m_NrOfBinsX };
+			const int binTask{ graph.AddTask([this, binIdx] { RenderBin(binIdx); }) };
+			graph.AddDependency(binTask, binningDone);
+			if (needsResolve) graph.AddDependency(resolveTask, binTask);
+		}
+	}
+
+	m_pJobSystem->Run(graph);
+}
+
+void dae::Renderer::BinTriangles(int chunkIdx) const
+{
+	const Stats::ScopedTimer rasterTimer{ Stats::Stage::Raster };
+	const Trace::Zone binningZone{ "Binning", chunkIdx };
+	const Perf::Scope binningCounters{ Perf::Stage::Raster };
+	const Allocations::Scope binningAllocations{ Allocations::Stage::Binning };
+
+	const int nrOfBins{ m_NrOfBinsX * m_NrOfBinsY };
+	std::vector<uint32_t>* pBins{ m_pBinnedTriangles + chunkIdx * nrOfBins };
+	for (int binIdx{}; binIdx < nrOfBins; ++binIdx)
+	{
+		pBins[binIdx].clear();
+	}
+
+	const std::vector<uint32_t>& indices{ m_pScene->GetMesh().indices };
+	const std::vector<Vertex_Out>& vertices{ m_VerticesOut };
+	const int nrOfTriangles{ static_cast<int>(indices.size() / 3) };
+	const int lastTriangle{ std::min((chunkIdx + 1) * BINNING_GRAIN, nrOfTriangles) };
+	Stats::Add(Stats::Counter::TrianglesSubmitted, lastTriangle - chunkIdx * BINNING_GRAIN);
+
+	for (int triangleIdx{ chunkIdx * BINNING_GRAIN }; triangleIdx < lastTriangle; ++triangleIdx)
+	{
+		int xMin{};
+		int yMin{};
+		int xMax{};
+		int yMax{};
+		const size_t index{ static_cast<size_t>(triangleIdx) * 3 };
+		if (!GetTriangleBounds(vertices[indices[index]], vertices[indices[index + 1]], vertices[indices[index + 2]], xMin, yMin, xMax, yMax)) continue;
+		if (xMin >= xMax || yMin >= yMax)
+		{
+			Stats::Add(Stats::Counter::TrianglesCulled, 1);
+			continue;
+		}
+
+		for (int binY{ yMin / BIN_SIZE }; binY <= (yMax - 1) / BIN_SIZE; ++binY)
+		{
+			for (int binX{ xMin / BIN_SIZE }; binX <= (xMax - 1) / BIN_SIZE; ++binX)
+			{
+				pBins[binX + binY * m_NrOfBinsX].push_back(static_cast<uint32_t>(triangleIdx));
+			}
+		}
+	}
+}
+
+void dae::Renderer::RenderBin(int binIdx) const
+{
+	const Trace::Zone binZone{ "Bin", binIdx };
+	const Perf::Scope binCounters{ Perf::Stage::Raster };
+	const Allocations::Scope binAllocations{ Allocations::Stage::Raster };
+
+	const int binX{ binIdx % m_NrOfBinsX };
+	const int binY{ binIdx / m_NrOfBinsX };
+	const int xMin{ binX * BIN_SIZE };
+	const int yMin{ binY * BIN_SIZE };
+	const int xMax{ std::min(xMin + BIN_SIZE, m_Width) };
+	const int yMax{ std::min(yMin + BIN_SIZE, m_Height) };
+
+	const std::vector<uint32_t>& indices{ m_pScene->GetMesh().indices };
+	const std::vector<Vertex_Out>& vertices{ m_VerticesOut };
+	const int nrOfBins{ m_NrOfBinsX * m_NrOfBinsY };
+
+	// chunks in order, so overlapping triangles resolve the depth test like the serial path does
+	{
+		const Stats::ScopedTimer rasterTimer{ Stats::Stage::Raster };
+		for (int chunkIdx{}; chunkIdx < m_NrOfBinningChunks; ++chunkIdx)
+		{
+			for (const uint32_t triangleIdx : m_pBinnedTriangles[binIdx + chunkIdx * nrOfBins])
+			{
+				const size_t index{ static_cast<size_t>(triangleIdx) * 3 };
+				RenderTriangle(vertices[indices[index]], vertices[indices[index + 1]], vertices[indices[index + 2]], xMin, yMin, xMax, yMax);
+			}
+		}
+	}
+
+	// tiles of this bin nothing was drawn to
+	if (m_LazyClear)
+	{
+		ResolvePendingClears(xMin / TILE_SIZE, yMin / TILE_SIZE, (xMax + TILE_SIZE - 1) / TILE_SIZE, (yMax + TILE_SIZE - 1) / TILE_SIZE);
+	}
+}
+
+void dae::Renderer::ResolveBinRow(int binY) const
+{
+	const Trace::Zone resolveZone{ "Resolve", binY };
+	const Perf::Scope resolveCounters{ Perf::Stage::Resolve };
+	const Allocations::Scope resolveAllocations{ Allocations::Stage::Resolve };
+
+	const int firstRow{ binY * BIN_SIZE };
+	const int lastRow{ std::min(firstRow + BIN_SIZE, m_Height) };
+
+	if (m_HDRTarget)
+	{
+		ResolveHDRBuffer(firstRow, lastRow);
+	}
+	else if (m_TiledLayout)
+	{
+		DetileColorBuffer(firstRow, lastRow);
+	}
+}
+
+void dae::Renderer::RenderStripMesh(const Mesh& stripMesh, const std::vector<Vertex_Out>& vertices_out) const
 {
 	const std::vector<uint32_t>& indices{ stripMesh.indices };
 	assert(indices.size() > 2);
 	const size_t maxIndicesSize{ indices.size() - 2 };
+	const Stats::ScopedTimer rasterTimer{ Stats::Stage::Raster };
+	const Perf::Scope rasterCounters{ Perf::Stage::Raster };
 
 	for (size_t index{}; index < maxIndicesSize; ++index)
 	{
@@ -134,10 +704,11 @@ void dae::Renderer::RenderStripMesh(const Mesh& stripMesh) const
 		const uint32_t idx2{ indices[index + 2] };
 
 		if (idx0 == idx1 || idx1 == idx2) continue;
+		Stats::Add(Stats::Counter::TrianglesSubmitted, 1);
 
-		const Vertex_Out& v0{ stripMesh.vertices_out[idx0] };
-		const Vertex_Out& v1{ stripMesh.vertices_out[idx1] };
-		const Vertex_Out& v2{ stripMesh.vertices_out[idx2] };
+		const Vertex_Out& v0{ vertices_out[idx0] };
+		const Vertex_Out& v1{ vertices_out[idx1] };
+		const Vertex_Out& v2{ vertices_out[idx2] };
 
 		if (index & 1) // odd
 		{
@@ -152,7 +723,7 @@ void dae::Renderer::RenderStripMesh(const Mesh& stripMesh) const
 
 
 
-void dae::Renderer::RenderTriangle(const Vertex_Out& vertex0, const Vertex_Out& vertex1, const Vertex_Out& vertex2) const
+bool dae::Renderer::GetTriangleBounds(const Vertex_Out& vertex0, const Vertex_Out& vertex1, const Vertex_Out& vertex2, int& xMin, int& yMin, int& xMax, int& yMax) const
 {
 	constexpr int boundingOffset{ 5 };
 
@@ -167,18 +738,59 @@ void dae::Renderer::RenderTriangle(const Vertex_Out& vertex0, const Vertex_Out&
 		vertex0.position.y < 0.f || vertex0.position.y > m_Height ||
 		vertex1.position.y < 0.f || vertex1.position.y > m_Height ||
 		vertex2.position.y < 0.f || vertex2.position.y > m_Height
-		) return;
+		)
+	{
+		if constexpr (Stats::IS_ENABLED)
+		{
+			// all of it on the wrong side of one border -> culled, else it crosses the border and would need clipping
+			const bool isOutside
+			{
+				(vertex0.position.x < 0.f && vertex1.position.x < 0.f && vertex2.position.x < 0.f) ||
+				(vertex0.position.x > m_Width && vertex1.position.x > m_Width && vertex2.position.x > m_Width) ||
+				(vertex0.position.y < 0.f && vertex1.position.y < 0.f && vertex2.position.y < 0.f) ||
+				(vertex0.position.y > m_Height && vertex1.position.y > m_Height && vertex2.position.y > m_Height)
+			};
+			Stats::Add(isOutside ? Stats::Counter::TrianglesCulled : Stats::Counter::TrianglesClipped, 1);
+		}
+		return false;
+	}
 
 	const Vector2 vec0{ vertex0.position.GetXY() };
 	const Vector2 vec1{ vertex1.position.GetXY() };
 	const Vector2 vec2{ vertex2.position.GetXY() };
 
-	const int xMin{ std::max(static_cast<int>(std::min({ vec0.x, vec1.x, vec2.x }) - boundingOffset), 0) };
-	const int xMax{ std::min(static_cast<int>(std::max({ vec0.x, vec1.x, vec2.x }) + boundingOffset), m_Width) };
-	const int yMin{ std::max(static_cast<int>(std::min({ vec0.y, vec1.y, vec2.y }) - boundingOffset), 0) };
-	const int yMax{ std::min(static_cast<int>(std::max({ vec0.y, vec1.y, vec2.y }) + boundingOffset), m_Height) };
+	xMin = std::max(static_cast<int>(std::min({ vec0.x, vec1.x, vec2.x }) - boundingOffset), 0);
+	xMax = std::min(static_cast<int>(std::max({ vec0.x, vec1.x, vec2.x }) + boundingOffset), m_Width);
+	yMin = std::max(static_cast<int>(std::min({ vec0.y, vec1.y, vec2.y }) - boundingOffset), 0);
+	yMax = std::min(static_cast<int>(std::max({ vec0.y, vec1.y, vec2.y }) + boundingOffset), m_Height);
+
+	return !(xMax < 0 || xMin > m_Width || yMax < 0 || yMin > m_Height);
+}
+
+void dae::Renderer::RenderTriangle(const Vertex_Out& vertex0, const Vertex_Out& vertex1, const Vertex_Out& vertex2) const
+{
+	RenderTriangle(vertex0, vertex1, vertex2, 0, 0, m_Width, m_Height);
+}
+
+void dae::Renderer::RenderTriangle(const Vertex_Out& vertex0, const Vertex_Out& vertex1, const Vertex_Out& vertex2, int clipXMin, int clipYMin, int clipXMax, int clipYMax) const
+{
+	int xMin{};
+	int yMin{};
+	int xMax{};
+	int yMax{};
+	if (!GetTriangleBounds(vertex0, vertex1, vertex2, xMin, yMin, xMax, yMax)) return;
+
+	// only the part inside the clip rectangle, a bin when rasterizing in parallel
+	xMin = std::max(xMin, clipXMin);
+	yMin = std::max(yMin, clipYMin);
+	xMax = std::min(xMax, clipXMax);
+	yMax = std::min(yMax, clipYMax);
+
+	if (m_LazyClear) PrepareTiles(xMin, yMin, xMax, yMax);
 
-	if (xMax < 0 || xMin > m_Width || yMax < 0 || yMin > m_Height) return;
+	const Vector2 vec0{ vertex0.position.GetXY() };
+	const Vector2 vec1{ vertex1.position.GetXY() };
+	const Vector2 vec2{ vertex2.position.GetXY() };
 
 	const Vector2 edge0{ vec2 - vec1 };
 	const Vector2 edge1{ vec0 - vec2 };
@@ -192,11 +804,26 @@ void dae::Renderer::RenderTriangle(const Vertex_Out& vertex0, const Vertex_Out&
 	const float divideZ1{ 1.f / vertex1.position.z };
 	const float divideZ2{ 1.f / vertex2.position.z };
 
+	// the original float format keeps interpolating 1/z, the others interpolate z itself (linear in screen space)
+	const bool isHarmonicDepth{ m_DepthFormat == DepthFormat::Float32 };
+
 	const Vector2 uv0{ vertex0.uv * divideW0 };
 	const Vector2 uv1{ vertex1.uv * divideW1 };
 	const Vector2 uv2{ vertex2.uv * divideW2 };
 
 	ColorRGB pixelColor;
+	PixelBatch pixelBatch{};
+
+	// pipeline statistics, added once per triangle; dead code when they're compiled out
+	uint64_t nrOfPixelsTested{};
+	uint64_t nrOfPixelsDepthPassed{};
+	uint64_t nrOfPixelsShaded{};
+	const auto addPixelStats{ [&]
+		{
+			Stats::Add(Stats::Counter::PixelsTested, nrOfPixelsTested);
+			Stats::Add(Stats::Counter::PixelsDepthPassed, nrOfPixelsDepthPassed);
+			Stats::Add(Stats::Counter::PixelsShaded, nrOfPixelsShaded);
+		} };
 
 	for (int py{ yMin }; py < yMax; ++py)
 	{
@@ -215,17 +842,50 @@ void dae::Renderer::RenderTriangle(const Vertex_Out& vertex0, const Vertex_Out&
 				w1 *= invTotalWeight;
 				w2 *= invTotalWeight;
 
-				const float interPolatedZ{ 1.f / (divideZ0 * w0 + divideZ1 * w1 + divideZ2 * w2) }; // (depthValue)
-				const int pixelIdx{ px + (py * m_Width) };
-
-				if (interPolatedZ >= 0.f && interPolatedZ <= 1.f && m_pDepthBufferPixels[pixelIdx] >= interPolatedZ)
+				const float interPolatedZ // (depthValue)
+				{
+					isHarmonicDepth ?
+					1.f / (divideZ0 * w0 + divideZ1 * w1 + divideZ2 * w2) :
+					vertex0.position.z * w0 + vertex1.position.z * w1 + vertex2.position.z * w2
+				};
+				const int pixelIdx{ PixelIndex(px, py) };
+				++nrOfPixelsTested;
+				if (m_HeatmapMode == HeatmapMode::depthTests) ++m_pHeatmapPixels[pixelIdx];
+				// a batch flush counts its cycles to the pixels of the batch, the pixel's own count stops before it
+				ScopedCycles pixelCycles{ m_HeatmapMode == HeatmapMode::cycles ? m_pHeatmapPixels + pixelIdx : nullptr };
+
+				if (interPolatedZ >= 0.f && interPolatedZ <= 1.f && DepthTest(pixelIdx, interPolatedZ))
 				{
+					++nrOfPixelsDepthPassed;
 					const float interPolatedW{ 1.f / (divideW0 * w0 + divideW1 * w1 + divideW2 * w2) };
 					const Vector2 uvInterPolated{ (uv0 * w0 + uv1 * w1 + uv2 * w2) * interPolatedW };
 
-					if (uvInterPolated.x < 0 || uvInterPolated.x > 1.f || uvInterPolated.y < 0 || uvInterPolated.y > 1.f) return;
+					// uv outside the texture, only this pixel is dropped: dropping the rest of the triangle
+					// would depend on the raster order, which differs between the serial and the binned path
+					if (uvInterPolated.x < 0 || uvInterPolated.x > 1.f || uvInterPolated.y < 0 || uvInterPolated.y > 1.f) continue;
+
+					WriteDepth(pixelIdx, interPolatedZ);
+					++nrOfPixelsShaded;
+					if (m_HeatmapMode == HeatmapMode::shaded) ++m_pHeatmapPixels[pixelIdx];
+
+					const Vector3 normal{ (vertex0.normal * w0 + vertex1.normal * w1 + vertex2.normal * w2).Normalized() };
+					const Vector3 tangent{ (vertex0.tangent * w0 + vertex1.tangent * w1 + vertex2.tangent * w2).Normalized() };
+					const Vector3 viewDirection{ (vertex0.viewDirection * w0 + vertex1.viewDirection * w1 + vertex2.viewDirection * w2).Normalized() };
 
-					m_pDepthBufferPixels[pixelIdx] = interPolatedZ;
+					// queue the pixel, shading happens SIMD_WIDTH pixels at a time
+					if (m_SIMDShading && !m_MeshDepthBuffer)
+					{
+						const int lane{ pixelBatch.nrOfPixels++ };
+						pixelBatch.pixelIndices[lane] = pixelIdx;
+						pixelBatch.uv[lane] = uvInterPolated;
+						pixelBatch.normal[lane] = normal;
+						pixelBatch.tangent[lane] = tangent;
+						pixelBatch.viewDirection[lane] = viewDirection;
+
+						pixelCycles.Stop();
+						if (pixelBatch.nrOfPixels == SIMD_WIDTH) ShadePixelBatch(pixelBatch);
+						continue;
+					}
 
 					const Vertex_Out shadeVertex
 					{
@@ -237,37 +897,40 @@ void dae::Renderer::RenderTriangle(const Vertex_Out& vertex0, const Vertex_Out&
 						},
 						ColorRGB{},
 						uvInterPolated,
-						(vertex0.normal * w0 + vertex1.normal * w1 + vertex2.normal * w2).Normalized(),
-						(vertex0.tangent * w0 + vertex1.tangent * w1 + vertex2.tangent * w2).Normalized(),
-						(vertex0.viewDirection * w0 + vertex1.viewDirection * w1 + vertex2.viewDirection * w2).Normalized()
+						normal,
+						tangent,
+						viewDirection
 					};
 
 					if (m_MeshDepthBuffer)
 					{
-						pixelColor = Remap(interPolatedZ, 0.985f, 1.f);
+						pixelColor = Remap(GetStandardDepth(interPolatedZ), 0.985f, 1.f);
+						if (!m_HDRTarget)
+						{
+							m_pColorTargetPixels[pixelIdx] = m_pColorOutput->PackClamped(pixelColor);
+							continue;
+						}
 					}
 					else
 					{
 						PixelShading(shadeVertex, pixelColor);
 					}
 
-					pixelColor.MaxToOne();
-
-					m_pBackBufferPixels[pixelIdx] = SDL_MapRGB
-					(
-						m_pBackBuffer->format,
-						static_cast<uint8_t>(pixelColor.r * 255.f),
-						static_cast<uint8_t>(pixelColor.g * 255.f),
-						static_cast<uint8_t>(pixelColor.b * 255.f)
-					);
+					WritePixel(pixelIdx, pixelColor);
 				}
 			}
 		}
-	}	
+	}
+
+	// shade what is left in the last, partially filled batch
+	ShadePixelBatch(pixelBatch);
+	addPixelStats();
 }
 
 void dae::Renderer::PixelShading(const Vertex_Out& v, ColorRGB& pixelColor) const
 {
+	const Stats::ScopedTimer shadingTimer{ Stats::Stage::Shading };
+
 	// shading values
 	constexpr float lightIntensity{ 7.f };
 	const Vector3 lightDirection{ 0.577f, -0.577f, 0.577f }; // directional light
@@ -302,10 +965,12 @@ void dae::Renderer::PixelShading(const Vertex_Out& v, ColorRGB& pixelColor) cons
 	// lambert
 	const ColorRGB lambert{ BRDF::Lambert(m_pDiffuseTexture->Sample(v.uv), lightIntensity) };
 
-	// phong
+	// phong or blinn-phong
 	const ColorRGB specularColor{ m_pSpecularTexture->Sample(v.uv) };
 	const float glossiness{ (m_pGlossTexture->Sample(v.uv)).r * shininess };
-	const ColorRGB specular{ BRDF::Phong(specularColor, glossiness , -lightDirection, v.viewDirection, normal) };
+	const ColorRGB specular{ m_SpecularModel == SpecularModel::blinnPhong ?
+		BRDF::BlinnPhong(specularColor, glossiness, -lightDirection, v.viewDirection, normal, m_PhongPrecision) :
+		BRDF::Phong(specularColor, glossiness, -lightDirection, v.viewDirection, normal, m_PhongPrecision) };
 
 	switch (m_MeshShadingMode)
 	{
@@ -329,7 +994,443 @@ void dae::Renderer::PixelShading(const Vertex_Out& v, ColorRGB& pixelColor) cons
 	return;
 }
 
-void Renderer::VertexTransformationFunction(const std::vector<Vertex>& vertices_in, std::vector<Vertex_Out>& vertices_out)
+void dae::Renderer::PixelShading(const PixelBatch& batch, ColorRGBx4& pixelColors) const
+{
+	// shading values
+	constexpr float lightIntensity{ 7.f };
+	const Vector3 lightDirection{ 0.577f, -0.577f, 0.577f }; // directional light
+	constexpr float shininess{ 25.f };
+	const ColorRGBx4 ambient{ ColorRGB{ 0.03f, 0.03f, 0.03f } };
+
+	const Vector3x4 toLight{ -lightDirection };
+	const Vector3x4 vertexNormal{ Vector3x4::FromArray(batch.normal) };
+
+	Vector3x4 normal{};
+	if (m_MeshNormalMap)
+	{
+		//binormal
+		const Vector3x4 tangent{ Vector3x4::FromArray(batch.tangent) };
+		const Vector3x4 binormal{ Vector3x4::Cross(vertexNormal, tangent) };
+
+		ColorRGB sampledNormalColors[SIMD_WIDTH];
+		for (int lane{}; lane < SIMD_WIDTH; ++lane)
+		{
+			sampledNormalColors[lane] = m_pNormalMapTexture->Sample(batch.uv[lane]);
+		}
+
+		const ColorRGBx4 sampledNormal{ ColorRGBx4::FromArray(sampledNormalColors) };
+		const __m128 two{ _mm_set1_ps(2.f) };
+		const __m128 one{ _mm_set1_ps(1.f) };
+
+		// same as tangentSpaceAxis.TransformVector in the scalar path
+		normal = (
+			tangent * _mm_sub_ps(_mm_mul_ps(sampledNormal.r, two), one) +
+			binormal * _mm_sub_ps(_mm_mul_ps(sampledNormal.g, two), one) +
+			vertexNormal * _mm_sub_ps(_mm_mul_ps(sampledNormal.b, two), one)
+			).Normalized();
+	}
+	else
+	{
+		normal = vertexNormal;
+	}
+
+	// observed Area
+	const __m128 observedArea{ Vector3x4::Dot(normal, toLight) };
+	const __m128 litMask{ _mm_cmpge_ps(observedArea, _mm_setzero_ps()) };
+	const int litLanes{ _mm_movemask_ps(litMask) };
+
+	pixelColors = ambient;
+	if (!litLanes) return;
+
+	// sample only the lanes that get lit
+	ColorRGB diffuseColors[SIMD_WIDTH]{};
+	ColorRGB specularColors[SIMD_WIDTH]{};
+	alignas(16) float glossiness[SIMD_WIDTH]{};
+	for (int lane{}; lane < SIMD_WIDTH; ++lane)
+	{
+		if (!(litLanes & (1 << lane))) continue;
+
+		diffuseColors[lane] = m_pDiffuseTexture->Sample(batch.uv[lane]);
+		specularColors[lane] = m_pSpecularTexture->Sample(batch.uv[lane]);
+		glossiness[lane] = m_pGlossTexture->Sample(batch.uv[lane]).r * shininess;
+	}
+
+	// lambert
+	const ColorRGBx4 lambert{ BRDF::Lambert(ColorRGBx4::FromArray(diffuseColors), ColorRGBx4{ _mm_set1_ps(lightIntensity) }) };
+
+	// phong or blinn-phong
+	const Vector3x4 viewDirection{ Vector3x4::FromArray(batch.viewDirection) };
+	const ColorRGBx4 specular{ m_SpecularModel == SpecularModel::blinnPhong ?
+		BRDF::BlinnPhong(ColorRGBx4::FromArray(specularColors), _mm_load_ps(glossiness), toLight, viewDirection, normal, m_PhongPrecision) :
+		BRDF::Phong(ColorRGBx4::FromArray(specularColors), _mm_load_ps(glossiness), toLight, viewDirection, normal, m_PhongPrecision) };
+
+	ColorRGBx4 litColors{};
+	switch (m_MeshShadingMode)
+	{
+	case ShadingMode::observedArea:
+		litColors = ambient + ColorRGBx4{ observedArea };
+		break;
+	case ShadingMode::diffused: // (incl OA)
+		litColors = ambient + lambert * observedArea;
+		break;
+	case ShadingMode::specular: // (incl OA)
+		litColors = ambient + specular * observedArea;
+		break;
+	case ShadingMode::combined:
+		litColors = ambient + (lambert + specular) * observedArea;
+		break;
+	default:
+		assert(false);
+		return;
+	}
+
+	pixelColors = ColorRGBx4::Select(ambient, litColors, litMask);
+}
+
+void dae::Renderer::ShadePixelBatch(PixelBatch& batch) const
+{
+	if (batch.nrOfPixels == 0) return;
+	const Stats::ScopedTimer shadingTimer{ Stats::Stage::Shading };
+
+	// cycles heatmap, the cost of the batch gets split over its pixels
+	const uint64_t shadingStart{ m_HeatmapMode == HeatmapMode::cycles ? __rdtsc() : 0 };
+	const auto addShadingCycles{ [&]
+		{
+			if (m_HeatmapMode != HeatmapMode::cycles) return;
+			const uint32_t cyclesPerPixel{ static_cast<uint32_t>((__rdtsc() - shadingStart) / batch.nrOfPixels) };
+			for (int lane{}; lane < batch.nrOfPixels; ++lane)
+			{
+				m_pHeatmapPixels[batch.pixelIndices[lane]] += cyclesPerPixel;
+			}
+		} };
+
+	// pad unused lanes with the first pixel, their results get discarded
+	for (int lane{ batch.nrOfPixels }; lane < SIMD_WIDTH; ++lane)
+	{
+		batch.uv[lane] = batch.uv[0];
+		batch.normal[lane] = batch.normal[0];
+		batch.tangent[lane] = batch.tangent[0];
+		batch.viewDirection[lane] = batch.viewDirection[0];
+	}
+
+	ColorRGBx4 shadedColors{};
+	PixelShading(batch, shadedColors);
+
+	if (m_HDRTarget)
+	{
+		ColorRGB pixelColors[SIMD_WIDTH];
+		shadedColors.ToArray(pixelColors);
+
+		for (int lane{}; lane < batch.nrOfPixels; ++lane)
+		{
+			WritePixel(batch.pixelIndices[lane], pixelColors[lane]);
+		}
+
+		addShadingCycles();
+		batch.nrOfPixels = 0;
+		return;
+	}
+
+	uint32_t packedColors[SIMD_WIDTH];
+	m_pColorOutput->Pack(shadedColors, packedColors);
+
+	for (int lane{}; lane < batch.nrOfPixels; ++lane)
+	{
+		m_pColorTargetPixels[batch.pixelIndices[lane]] = packedColors[lane];
+	}
+
+	addShadingCycles();
+	batch.nrOfPixels = 0;
+}
+
+void dae::Renderer::WritePixel(int pixelIdx, const ColorRGB& color) const
+{
+	if (m_HDRTarget)
+	{
+		m_pHDRBufferPixels[pixelIdx] = color.r;
+		m_pHDRBufferPixels[pixelIdx + m_NrOfBufferPixels] = color.g;
+		m_pHDRBufferPixels[pixelIdx + 2 * m_NrOfBufferPixels] = color.b;
+	}
+	else
+	{
+		m_pColorTargetPixels[pixelIdx] = m_pColorOutput->Pack(color);
+	}
+}
+
+namespace
+{
+	constexpr float DEPTH24_MAX{ 16777215.f };
+	constexpr float DEPTH16_MAX{ 65535.f };
+
+	uint32_t QuantizeDepth24(float depth)
+	{
+		return static_cast<uint32_t>(depth * DEPTH24_MAX + 0.5f);
+	}
+
+	uint16_t QuantizeDepth16(float depth)
+	{
+		return static_cast<uint16_t>(depth * DEPTH16_MAX + 0.5f);
+	}
+}
+
+bool dae::Renderer::DepthTest(int pixelIdx, float depth) const
+{
+	switch (m_DepthFormat)
+	{
+	case DepthFormat::ReversedFloat32:
+		return m_pDepthBufferPixels[pixelIdx] <= depth;
+	case DepthFormat::Unorm24:
+		return m_pDepth24BufferPixels[pixelIdx] >= QuantizeDepth24(depth);
+	case DepthFormat::Unorm16:
+		return m_pDepth16BufferPixels[pixelIdx] >= QuantizeDepth16(depth);
+	case DepthFormat::Float32:
+	default:
+		return m_pDepthBufferPixels[pixelIdx] >= depth;
+	}
+}
+
+void dae::Renderer::WriteDepth(int pixelIdx, float depth) const
+{
+	switch (m_DepthFormat)
+	{
+	case DepthFormat::Unorm24:
+		m_pDepth24BufferPixels[pixelIdx] = QuantizeDepth24(depth);
+		break;
+	case DepthFormat::Unorm16:
+		m_pDepth16BufferPixels[pixelIdx] = QuantizeDepth16(depth);
+		break;
+	case DepthFormat::Float32:
+	case DepthFormat::ReversedFloat32:
+	default:
+		m_pDepthBufferPixels[pixelIdx] = depth;
+		break;
+	}
+}
+
+void dae::Renderer::ClearDepth(int firstPixel, int nrOfPixels) const
+{
+	switch (m_DepthFormat)
+	{
+	case DepthFormat::ReversedFloat32:
+		std::fill_n(m_pDepthBufferPixels + firstPixel, nrOfPixels, 0.f);
+		break;
+	case DepthFormat::Unorm24:
+		std::fill_n(m_pDepth24BufferPixels + firstPixel, nrOfPixels, static_cast<uint32_t>(DEPTH24_MAX));
+		break;
+	case DepthFormat::Unorm16:
+		std::fill_n(m_pDepth16BufferPixels + firstPixel, nrOfPixels, static_cast<uint16_t>(DEPTH16_MAX));
+		break;
+	case DepthFormat::Float32:
+	default:
+		std::fill_n(m_pDepthBufferPixels + firstPixel, nrOfPixels, FLT_MAX);
+		break;
+	}
+}
+
+void dae::Renderer::ClearHDRColor(int firstPixel, int nrOfPixels) const
+{
+	std::fill_n(m_pHDRBufferPixels + firstPixel, nrOfPixels, m_HDRClearColor.r);
+	std::fill_n(m_pHDRBufferPixels + firstPixel + m_NrOfBufferPixels, nrOfPixels, m_HDRClearColor.g);
+	std::fill_n(m_pHDRBufferPixels + firstPixel + 2 * m_NrOfBufferPixels, nrOfPixels, m_HDRClearColor.b);
+}
+
+// depth as standard Z in [0, 1], with the precision the buffer would store it at
+float dae::Renderer::GetStandardDepth(float depth) const
+{
+	switch (m_DepthFormat)
+	{
+	case DepthFormat::ReversedFloat32:
+		return 1.f - depth;
+	case DepthFormat::Unorm24:
+		return QuantizeDepth24(depth) / DEPTH24_MAX;
+	case DepthFormat::Unorm16:
+		return QuantizeDepth16(depth) / DEPTH16_MAX;
+	case DepthFormat::Float32:
+	default:
+		return depth;
+	}
+}
+
+// smallest view space distance that still changes the stored depth, at viewDistance from the camera
+float dae::Renderer::GetDepthResolution(float viewDistance) const
+{
+	const double near{ m_Camera.near };
+	const double far{ m_Camera.far };
+	const double w{ viewDistance };
+
+	// both projections: |d depth / d w| = far * near / ((far - near) * w^2)
+	const double depthSlope{ far * near / ((far - near) * w * w) };
+
+	double depthStep{};
+	switch (m_DepthFormat)
+	{
+	case DepthFormat::ReversedFloat32:
+	{
+		const float depth{ static_cast<float>(near * (far - w) / ((far - near) * w)) };
+		depthStep = depth - std::nextafter(depth, 0.f);
+		break;
+	}
+	case DepthFormat::Unorm24:
+		depthStep = 1.0 / DEPTH24_MAX;
+		break;
+	case DepthFormat::Unorm16:
+		depthStep = 1.0 / DEPTH16_MAX;
+		break;
+	case DepthFormat::Float32:
+	default:
+	{
+		const float depth{ static_cast<float>(far / (far - near) - far * near / ((far - near) * w)) };
+		depthStep = std::nextafter(depth, 1.f) - depth;
+		break;
+	}
+	}
+
+	return static_cast<float>(depthStep / depthSlope);
+}
+
+int dae::Renderer::GetDepthBytesPerPixel() const
+{
+	switch (m_DepthFormat)
+	{
+	case DepthFormat::Unorm16:
+		return static_cast<int>(sizeof(uint16_t));
+	case DepthFormat::Unorm24:
+		return static_cast<int>(sizeof(uint32_t));
+	case DepthFormat::Float32:
+	case DepthFormat::ReversedFloat32:
+	default:
+		return static_cast<int>(sizeof(float));
+	}
+}
+
+int dae::Renderer::PixelIndex(int px, int py) const
+{
+	if (!m_TiledLayout) return px + py * m_Width;
+
+	// tiles stored one after the other, pixels row-major inside a tile
+	const int tileIdx{ px / TILE_SIZE + (py / TILE_SIZE) * m_NrOfTilesX };
+	return tileIdx * TILE_SIZE * TILE_SIZE + (py % TILE_SIZE) * TILE_SIZE + px % TILE_SIZE;
+}
+
+void dae::Renderer::DetileColorBuffer() const
+{
+	DetileColorBuffer(0, m_Height);
+}
+
+void dae::Renderer::DetileColorBuffer(int firstRow, int lastRow) const
+{
+	for (int py{ firstRow }; py < lastRow; ++py)
+	{
+		for (int tileX{}; tileX < m_NrOfTilesX; ++tileX)
+		{
+			const int px{ tileX * TILE_SIZE };
+			std::copy_n(m_pTiledColorPixels + PixelIndex(px, py), std::min(TILE_SIZE, m_Width - px), m_pBackBufferPixels + px + py * m_Width);
+		}
+	}
+}
+
+void dae::Renderer::ResolveHDRBuffer() const
+{
+	ResolveHDRBuffer(0, m_Height);
+}
+
+void dae::Renderer::ResolveHDRBuffer(int firstRow, int lastRow) const
+{
+	if (!m_TiledLayout)
+	{
+		ResolveHDRSpan(firstRow * m_Width, firstRow * m_Width, (lastRow - firstRow) * m_Width);
+		return;
+	}
+
+	// one tile row at a time, detiling on the way out
+	for (int py{ firstRow }; py < lastRow; ++py)
+	{
+		for (int tileX{}; tileX < m_NrOfTilesX; ++tileX)
+		{
+			const int px{ tileX * TILE_SIZE };
+			ResolveHDRSpan(PixelIndex(px, py), px + py * m_Width, std::min(TILE_SIZE, m_Width - px));
+		}
+	}
+}
+
+void dae::Renderer::ResolveHDRSpan(int firstSourcePixel, int firstTargetPixel, int nrOfPixels) const
+{
+	const float* pRed{ m_pHDRBufferPixels + firstSourcePixel };
+	const float* pGreen{ pRed + m_NrOfBufferPixels };
+	const float* pBlue{ pRed + 2 * m_NrOfBufferPixels };
+	uint32_t* pTarget{ m_pBackBufferPixels + firstTargetPixel };
+
+	// pixels nothing was drawn to keep the LDR background
+	const auto isClear{ [this](float red, float green, float blue)
+		{
+			return red == m_HDRClearColor.r && green == m_HDRClearColor.g && blue == m_HDRClearColor.b;
+		} };
+
+	// the depth view holds [0, 1] values, exposure and tone mapping are for shaded color only
+	if (m_MeshDepthBuffer)
+	{
+		for (int pixelIdx{}; pixelIdx < nrOfPixels; ++pixelIdx)
+		{
+			pTarget[pixelIdx] = isClear(pRed[pixelIdx], pGreen[pixelIdx], pBlue[pixelIdx]) ?
+				m_ClearColor : m_pColorOutput->PackClamped({ pRed[pixelIdx], pGreen[pixelIdx], pBlue[pixelIdx] });
+		}
+		return;
+	}
+
+	// SIMD_WIDTH consecutive pixels per iteration, planes stream straight into the packer;
+	// lanes still holding the clear color, whole untouched tiles included, skip the tone mapping
+	const ColorRGBx4 clearColors{ _mm_set1_ps(m_HDRClearColor.r), _mm_set1_ps(m_HDRClearColor.g), _mm_set1_ps(m_HDRClearColor.b) };
+	int pixelIdx{};
+	for (; pixelIdx + SIMD_WIDTH <= nrOfPixels; pixelIdx += SIMD_WIDTH)
+	{
+		const ColorRGBx4 colors{ _mm_loadu_ps(pRed + pixelIdx), _mm_loadu_ps(pGreen + pixelIdx), _mm_loadu_ps(pBlue + pixelIdx) };
+		const int clearMask{ _mm_movemask_ps(_mm_and_ps(_mm_and_ps(_mm_cmpeq_ps(colors.r, clearColors.r), _mm_cmpeq_ps(colors.g, clearColors.g)), _mm_cmpeq_ps(colors.b, clearColors.b))) };
+		if (clearMask != (1 << SIMD_WIDTH) - 1) m_pColorOutput->Pack(colors, pTarget + pixelIdx);
+
+		for (int lane{}; lane < SIMD_WIDTH; ++lane)
+		{
+			if (clearMask & (1 << lane)) pTarget[pixelIdx + lane] = m_ClearColor;
+		}
+	}
+
+	for (; pixelIdx < nrOfPixels; ++pixelIdx)
+	{
+		pTarget[pixelIdx] = isClear(pRed[pixelIdx], pGreen[pixelIdx], pBlue[pixelIdx]) ?
+			m_ClearColor : m_pColorOutput->Pack({ pRed[pixelIdx], pGreen[pixelIdx], pBlue[pixelIdx] });
+	}
+}
+
+void dae::Renderer::ResolveHeatmap() const
+{
+	// counts on a fixed scale so frames compare, cycles relative to the most expensive pixel of the frame
+	constexpr float maxCount{ 8.f };
+	float logMaxCycles{ 1.f };
+	if (m_HeatmapMode == HeatmapMode::cycles)
+	{
+		logMaxCycles = std::log1p(static_cast<float>(*std::max_element(m_pHeatmapPixels, m_pHeatmapPixels + m_NrOfBufferPixels)));
+		if (logMaxCycles <= 0.f) logMaxCycles = 1.f;
+	}
+
+	// untouched pixels keep the frame's background
+	for (int py{}; py < m_Height; ++py)
+	{
+		for (int px{}; px < m_Width; ++px)
+		{
+			const uint32_t value{ m_pHeatmapPixels[PixelIndex(px, py)] };
+			if (value == 0) continue;
+
+			const float heat
+			{
+				m_HeatmapMode == HeatmapMode::cycles ?
+				std::log1p(static_cast<float>(value)) / logMaxCycles :
+				(value - 1.f) / (maxCount - 1.f)
+			};
+			m_pBackBufferPixels[px + py * m_Width] = m_pColorOutput->PackClamped(GetHeatColor(heat));
+		}
+	}
+}
+
+void Renderer::VertexTransformationFunction(const std::vector<Vertex>& vertices_in, std::vector<Vertex_Out>& vertices_out)
 {
 	if (vertices_in.empty()) return;				// make sure vertices_in isnt empty
 
@@ -339,11 +1440,44 @@ void Renderer::VertexTransformationFunction(const std::vector<Vertex>& vertices_
 
 	// Reserve same amount for vertices_out
 	if (vertices_out.empty()) vertices_out.resize(vertices_in.size());
-	
-	const float halfWidth{ m_Width * 0.5f};
-	const float halfHeight{ m_Height * 0.5f};
 
-	for (size_t idx{}; idx < vertices_out.size(); ++idx)
+	const int nrOfVertices{ static_cast<int>(vertices_out.size()) };
+	if (m_pJobSystem && m_UseJobSystem)
+	{
+		const auto transformVertices{ [this, &vertices_in, &vertices_out](int firstVertex, int lastVertex)
+			{
+				TransformVertices(vertices_in, vertices_out, firstVertex, lastVertex);
+			} };
+
+		// a single reference fits in the small buffer of std::function, three captures make it allocate every frame
+		m_pJobSystem->ParallelFor(0, nrOfVertices, VERTEX_GRAIN, [&transformVertices](int firstVertex, int lastVertex)
+			{
+				transformVertices(firstVertex, lastVertex);
+			});
+	}
+	else
+	{
+		TransformVertices(vertices_in, vertices_out, 0, nrOfVertices);
+	}
+}
+
+void Renderer::TransformVertices(const std::vector<Vertex>& vertices_in, std::vector<Vertex_Out>& vertices_out, int firstVertex, int lastVertex) const
+{
+	const Stats::ScopedTimer vertexTimer{ Stats::Stage::Vertex };
+	const Trace::Zone vertexZone{ "Vertices", firstVertex };
+	const Perf::Scope vertexCounters{ Perf::Stage::Vertex };
+	const Allocations::Scope vertexAllocations{ Allocations::Stage::Vertex };
+	Stats::Add(Stats::Counter::VerticesTransformed, lastVertex - firstVertex);
+
+	const float halfWidth{ m_Width * 0.5f };
+	const float halfHeight{ m_Height * 0.5f };
+
+	// matrices come from the frame snapshot, reversed Z only changes the depth so view directions keep the standard projection
+	const Matrix& worldMatrix{ m_FrameConstants.worldMatrix };
+	const Matrix& worldViewProjectionMatrix{ m_FrameConstants.worldViewProjectionMatrix };
+	const Matrix& positionMatrix{ m_FrameConstants.positionMatrix };
+
+	for (size_t idx{ static_cast<size_t>(firstVertex) }; idx < static_cast<size_t>(lastVertex); ++idx)
 	{
 		// change uv
 		vertices_out[idx].uv = vertices_in[idx].uv;
@@ -352,16 +1486,13 @@ void Renderer::VertexTransformationFunction(const std::vector<Vertex>& vertices_
 		vertices_out[idx].color = vertices_in[idx].color;
 
 		// change normal
-		vertices_out[idx].normal = m_TriangleListMesh.worldMatrix.TransformVector(vertices_in[idx].normal); // update normal only with worldMatrix
+		vertices_out[idx].normal = worldMatrix.TransformVector(vertices_in[idx].normal); // update normal only with worldMatrix
 
 		// change tangent
-		vertices_out[idx].tangent = m_TriangleListMesh.worldMatrix.TransformPoint(vertices_in[idx].tangent);
-
-		// WorldViewProjectionMatrix 
-		const Matrix worldViewProjectionMatrix{ m_TriangleListMesh.worldMatrix * m_Camera.viewMatrix * m_Camera.projectionMatrix };
+		vertices_out[idx].tangent = worldMatrix.TransformPoint(vertices_in[idx].tangent);
 
 		// set in vertices out
-		vertices_out[idx].position = worldViewProjectionMatrix.TransformPoint({ vertices_in[idx].position, vertices_in[idx].position.z });
+		vertices_out[idx].position = positionMatrix.TransformPoint({ vertices_in[idx].position, vertices_in[idx].position.z });
 
 		// set viewDirection
 		vertices_out[idx].viewDirection = worldViewProjectionMatrix.TransformPoint(vertices_in[idx].position).Normalized();
@@ -391,6 +1522,34 @@ void dae::Renderer::ToggleDepthBuffer()
 	}
 }
 
+void dae::Renderer::CycleHeatmap()
+{
+	switch (m_HeatmapMode)
+	{
+	case HeatmapMode::off:
+		m_HeatmapMode = HeatmapMode::depthTests;
+		std::cout << "Heatmap: depth tests per pixel (blue 1 - red 8+)\n";
+		break;
+	case HeatmapMode::depthTests:
+		m_HeatmapMode = HeatmapMode::shaded;
+		std::cout << "Heatmap: shades per pixel (blue 1 - red 8+)\n";
+		break;
+	case HeatmapMode::shaded:
+		m_HeatmapMode = HeatmapMode::cycles;
+		std::cout << "Heatmap: cycles per pixel (log scale, red = most expensive pixel)\n";
+		break;
+	case HeatmapMode::cycles:
+		m_HeatmapMode = HeatmapMode::off;
+		std::cout << "Heatmap: OFF\n";
+		break;
+	default:
+		assert(false);
+		break;
+	}
+
+	UpdateTargetAllocations();
+}
+
 void dae::Renderer::ToggleRotation()
 {
 	m_MeshRotating = !m_MeshRotating;
@@ -404,6 +1563,15 @@ void dae::Renderer::ToggleRotation()
 	}
 }
 
+void dae::Renderer::SetMeshRotation(float angle)
+{
+	// programmatic, the timer no longer drives the rotation
+	m_MeshRotating = false;
+	m_MeshRotateAngle = angle;
+	m_MeshRotationMatrix = Matrix::CreateRotation(0.f, m_MeshRotateAngle, 0.f);
+	m_WorldMatrix = m_MeshRotationMatrix * m_MeshTranslationMatrix;
+}
+
 void dae::Renderer::ToggleNormalMap()
 {
 	m_MeshNormalMap = !m_MeshNormalMap;
@@ -443,12 +1611,408 @@ void dae::Renderer::CycleShadingMode()
 	}
 }
 
+void dae::Renderer::ToggleSpecularModel()
+{
+	if (m_SpecularModel == SpecularModel::phong)
+	{
+		m_SpecularModel = SpecularModel::blinnPhong;
+		std::cout << "SpecularModel: Blinn-Phong\n";
+	}
+	else
+	{
+		m_SpecularModel = SpecularModel::phong;
+		std::cout << "SpecularModel: Phong\n";
+	}
+}
+
+void dae::Renderer::CyclePhongPrecision()
+{
+	constexpr float shininess{ 25.f };
+
+	switch (m_PhongPrecision)
+	{
+	case PowPrecision::Exact:
+		m_PhongPrecision = PowPrecision::High;
+		std::cout << "PhongPrecision: High";
+		break;
+	case PowPrecision::High:
+		m_PhongPrecision = PowPrecision::Medium;
+		std::cout << "PhongPrecision: Medium";
+		break;
+	case PowPrecision::Medium:
+		m_PhongPrecision = PowPrecision::Low;
+		std::cout << "PhongPrecision: Low";
+		break;
+	case PowPrecision::Low:
+		m_PhongPrecision = PowPrecision::Exact;
+		std::cout << "PhongPrecision: Exact\n";
+		return;
+	default:
+		assert(false);
+		return;
+	}
+
+	// error against powf over the exponent range the gloss map can produce
+	const PowErrorReport report{ MeasurePowError(m_PhongPrecision, shininess) };
+	std::cout << " (max abs error: " << report.maxAbsError
+		<< ", mean abs error: " << report.meanAbsError
+		<< ", max rel error: " << report.maxRelError << ")\n";
+}
+
+void dae::Renderer::ToggleSIMDShading()
+{
+	m_SIMDShading = !m_SIMDShading;
+	if (m_SIMDShading)
+	{
+		std::cout << "SIMD Shading: ON\n";
+	}
+	else
+	{
+		std::cout << "SIMD Shading: OFF\n";
+	}
+}
+
+void dae::Renderer::CycleToneMapper()
+{
+	switch (m_pColorOutput->GetToneMapper())
+	{
+	case ToneMapper::MaxToOne:
+		m_pColorOutput->SetToneMapper(ToneMapper::Reinhard);
+		std::cout << "ToneMapper: Reinhard\n";
+		break;
+	case ToneMapper::Reinhard:
+		m_pColorOutput->SetToneMapper(ToneMapper::ACES);
+		std::cout << "ToneMapper: ACES\n";
+		break;
+	case ToneMapper::ACES:
+		m_pColorOutput->SetToneMapper(ToneMapper::MaxToOne);
+		std::cout << "ToneMapper: MaxToOne\n";
+		break;
+	default:
+		assert(false);
+		break;
+	}
+}
+
+void dae::Renderer::ToggleSRGBEncode()
+{
+	m_pColorOutput->SetSRGBEncode(!m_pColorOutput->GetSRGBEncode());
+	if (m_pColorOutput->GetSRGBEncode())
+	{
+		std::cout << "sRGB Encode: ON\n";
+	}
+	else
+	{
+		std::cout << "sRGB Encode: OFF\n";
+	}
+}
+
+void dae::Renderer::ToggleHDRTarget()
+{
+	m_HDRTarget = !m_HDRTarget;
+	UpdateTargetAllocations();
+
+	// the other color target holds stale data
+	std::fill_n(m_pTileFlags, m_NrOfTilesX * m_NrOfTilesY, uint8_t(tilePendingDepth | tilePendingColor));
+
+	if (m_HDRTarget)
+	{
+		std::cout << "HDR Target: ON\n";
+	}
+	else
+	{
+		std::cout << "HDR Target: OFF\n";
+	}
+}
+
+void dae::Renderer::ToggleLazyClear()
+{
+	m_LazyClear = !m_LazyClear;
+
+	// flags went stale while the eager clear was in use
+	std::fill_n(m_pTileFlags, m_NrOfTilesX * m_NrOfTilesY, uint8_t(tilePendingDepth | tilePendingColor));
+
+	if (m_LazyClear)
+	{
+		std::cout << "Lazy Clear: ON\n";
+	}
+	else
+	{
+		std::cout << "Lazy Clear: OFF\n";
+	}
+}
+
+void dae::Renderer::ToggleTiledLayout()
+{
+	m_TiledLayout = !m_TiledLayout;
+	UpdateTargetAllocations();
+	m_pColorTargetPixels = m_TiledLayout ? m_pTiledColorPixels : m_pBackBufferPixels;
+
+	// buffers hold data in the other layout
+	std::fill_n(m_pTileFlags, m_NrOfTilesX * m_NrOfTilesY, uint8_t(tilePendingDepth | tilePendingColor));
+
+	if (m_TiledLayout)
+	{
+		std::cout << "Tiled Layout: ON\n";
+	}
+	else
+	{
+		std::cout << "Tiled Layout: OFF\n";
+	}
+}
+
+void dae::Renderer::ToggleZeroCopyPresent()
+{
+	m_ZeroCopyPresent = !m_ZeroCopyPresent;
+	SelectRenderTarget();
+
+	if (m_pRenderTarget == m_pFrontBuffer)
+	{
+		std::cout << "Zero-Copy Present: ON\n";
+	}
+	else if (m_ZeroCopyPresent)
+	{
+		std::cout << "Zero-Copy Present: ON (window format differs, blitting)\n";
+	}
+	else
+	{
+		std::cout << "Zero-Copy Present: OFF\n";
+	}
+}
+
+void dae::Renderer::ToggleAsyncPresent()
+{
+	if (m_pPresenter)
+	{
+		const int nrOfPresentedFrames{ m_pPresenter->GetNrOfPresentedFrames() };
+		const int nrOfDroppedFrames{ m_pPresenter->GetNrOfDroppedFrames() };
+
+		delete m_pPresenter;
+		m_pPresenter = nullptr;
+		SelectRenderTarget();
+
+		std::cout << "Async Present: OFF (" << nrOfPresentedFrames << " presented, " << nrOfDroppedFrames << " dropped)\n";
+	}
+	else if (!m_pWindow)
+	{
+		std::cout << "Async Present: unavailable (headless)\n";
+	}
+	else
+	{
+		m_pPresenter = new FramePresenter{ m_pWindow, m_pBackBuffer->format, m_Width, m_Height };
+		m_pPresenter->SetPolicy(m_PresentPolicy);
+
+		std::cout << "Async Present: ON\n";
+	}
+}
+
+void dae::Renderer::TogglePresentPolicy()
+{
+	m_PresentPolicy = m_PresentPolicy == PresentPolicy::Block ? PresentPolicy::DropOldest : PresentPolicy::Block;
+	if (m_pPresenter) m_pPresenter->SetPolicy(m_PresentPolicy);
+
+	if (m_PresentPolicy == PresentPolicy::Block)
+	{
+		std::cout << "Present Policy: Block (throughput)\n";
+	}
+	else
+	{
+		std::cout << "Present Policy: DropOldest (latency)\n";
+	}
+}
+
+void dae::Renderer::TogglePipelinedFrames()
+{
+	if (m_pFrameWorker)
+	{
+		delete m_pFrameWorker;
+		m_pFrameWorker = nullptr;
+
+		std::cout << "Pipelined Frames: OFF (geometry overlapped raster " << GetPipelineOverlap() * 100.f << "% of the time)\n";
+	}
+	else
+	{
+		m_pFrameWorker = new FrameWorker{};
+		m_GeometryTime = 0.0;
+		m_OverlappedGeometryTime = 0.0;
+
+		std::cout << "Pipelined Frames: ON\n";
+	}
+}
+
+// fraction of geometry stage time that ran while the previous frame was being rasterized
+float dae::Renderer::GetPipelineOverlap() const
+{
+	if (m_GeometryTime <= 0.0) return 0.f;
+	return static_cast<float>(m_OverlappedGeometryTime / m_GeometryTime);
+}
+
+void dae::Renderer::ToggleJobSystem()
+{
+	if (!m_pJobSystem)
+	{
+		std::cout << "Job System: unavailable\n";
+		return;
+	}
+
+	m_UseJobSystem = !m_UseJobSystem;
+	if (m_UseJobSystem)
+	{
+		std::cout << "Job System: ON (" << m_pJobSystem->GetNrOfWorkers() << " workers)\n";
+	}
+	else
+	{
+		std::cout << "Job System: OFF\n";
+	}
+}
+
+void dae::Renderer::CycleDepthFormat()
+{
+	switch (m_DepthFormat)
+	{
+	case DepthFormat::Float32:
+		SetDepthFormat(DepthFormat::ReversedFloat32);
+		std::cout << "DepthFormat: ReversedFloat32\n";
+		break;
+	case DepthFormat::ReversedFloat32:
+		SetDepthFormat(DepthFormat::Unorm24);
+		std::cout << "DepthFormat: Unorm24\n";
+		break;
+	case DepthFormat::Unorm24:
+		SetDepthFormat(DepthFormat::Unorm16);
+		std::cout << "DepthFormat: Unorm16\n";
+		break;
+	case DepthFormat::Unorm16:
+		SetDepthFormat(DepthFormat::Float32);
+		std::cout << "DepthFormat: Float32\n";
+		break;
+	default:
+		assert(false);
+		break;
+	}
+}
+
+void dae::Renderer::SetDepthFormat(DepthFormat depthFormat)
+{
+	m_DepthFormat = depthFormat;
+	UpdateTargetAllocations();
+
+	// the newly selected buffer holds stale depth
+	ClearDepth(0, m_NrOfBufferPixels);
+}
+
+void dae::Renderer::AdjustExposure(float stops)
+{
+	m_pColorOutput->SetExposure(m_pColorOutput->GetExposure() * exp2f(stops));
+	std::cout << "Exposure: " << m_pColorOutput->GetExposure() << "\n";
+}
+
 float dae::Renderer::Remap(float v, float min, float max) const
 {
 	return std::clamp((v - min) / (max - min), 0.f, 1.f);
 }
 
+void dae::Renderer::UpdateTargetAllocations()
+{
+	// only what the current depth format and color modes render into exists, a context with the defaults stays small
+	const bool isFloatDepth{ m_DepthFormat == DepthFormat::Float32 || m_DepthFormat == DepthFormat::ReversedFloat32 };
+	UpdateAllocation(m_pDepthBufferPixels, isFloatDepth, m_NrOfBufferPixels);
+	UpdateAllocation(m_pDepth24BufferPixels, m_DepthFormat == DepthFormat::Unorm24, m_NrOfBufferPixels);
+	UpdateAllocation(m_pDepth16BufferPixels, m_DepthFormat == DepthFormat::Unorm16, m_NrOfBufferPixels);
+	UpdateAllocation(m_pTiledColorPixels, m_TiledLayout, m_NrOfBufferPixels);
+	UpdateAllocation(m_pHDRBufferPixels, m_HDRTarget, m_NrOfBufferPixels * 3);
+	UpdateAllocation(m_pHeatmapPixels, m_HeatmapMode != HeatmapMode::off, m_NrOfBufferPixels);
+}
+
+void dae::Renderer::SelectRenderTarget()
+{
+	// the async present hands out a target every frame
+	if (m_pPresenter) return;
+
+	SetRenderTarget(m_ZeroCopyPresent && m_CanPresentDirect ? m_pFrontBuffer : m_pBackBuffer);
+}
+
+void dae::Renderer::SetRenderTarget(SDL_Surface* pRenderTarget)
+{
+	m_pRenderTarget = pRenderTarget;
+	m_pBackBufferPixels = (uint32_t*)m_pRenderTarget->pixels;
+	m_pColorTargetPixels = m_TiledLayout ? m_pTiledColorPixels : m_pBackBufferPixels;
+
+	// whatever the new target holds, it is not this frame's clear color
+	std::fill_n(m_pTileFlags, m_NrOfTilesX * m_NrOfTilesY, uint8_t(tilePendingDepth | tilePendingColor));
+}
+
 bool Renderer::SaveBufferToImage() const
 {
-	return SDL_SaveBMP(m_pBackBuffer, "Rasterizer_ColorBuffer.bmp");
+	return SaveBufferToImage("Rasterizer_ColorBuffer.bmp");
+}
+
+bool Renderer::SaveBufferToImage(const char* path) const
+{
+	// the present thread may still be blitting from the target
+	WaitForPresent();
+	return SDL_SaveBMP(m_pRenderTarget, path);
+}
+
+StageTimes Renderer::GetStageTimes() const
+{
+	WaitForFrame();
+	return m_StageTimes;
+}
+
+void Renderer::ResetStageTimes()
+{
+	WaitForFrame();
+	m_StageTimes = {};
+}
+
+size_t Renderer::GetMemoryFootprint() const
+{
+	WaitForFrame();
+
+	// a backbuffer wrapping the caller's pixels doesn't hold them
+	size_t nrOfBytes{ m_pBackBuffer->flags & SDL_PREALLOC ? 0 : static_cast<size_t>(m_pBackBuffer->pitch) * m_pBackBuffer->h };
+	if (m_pPresenter) nrOfBytes += FramePresenter::NR_OF_FRAMES * static_cast<size_t>(m_pBackBuffer->pitch) * m_pBackBuffer->h;
+
+	const size_t nrOfBufferPixels{ static_cast<size_t>(m_NrOfBufferPixels) };
+	if (m_pDepthBufferPixels) nrOfBytes += nrOfBufferPixels * sizeof(float);
+	if (m_pDepth24BufferPixels) nrOfBytes += nrOfBufferPixels * sizeof(uint32_t);
+	if (m_pDepth16BufferPixels) nrOfBytes += nrOfBufferPixels * sizeof(uint16_t);
+	if (m_pTiledColorPixels) nrOfBytes += nrOfBufferPixels * sizeof(uint32_t);
+	if (m_pHDRBufferPixels) nrOfBytes += nrOfBufferPixels * 3 * sizeof(float);
+	if (m_pHeatmapPixels) nrOfBytes += nrOfBufferPixels * sizeof(uint32_t);
+	nrOfBytes += static_cast<size_t>(m_NrOfTilesX) * m_NrOfTilesY;
+
+	nrOfBytes += (m_VerticesOut.capacity() + m_NextVerticesOut.capacity()) * sizeof(Vertex_Out);
+	const int nrOfBinLists{ m_NrOfBinningChunks * m_NrOfBinsX * m_NrOfBinsY };
+	for (int listIdx{}; listIdx < nrOfBinLists; ++listIdx)
+	{
+		nrOfBytes += sizeof(std::vector<uint32_t>) + m_pBinnedTriangles[listIdx].capacity() * sizeof(uint32_t);
+	}
+
+	return nrOfBytes;
+}
+
+const uint32_t* Renderer::GetPixels() const
+{
+	WaitForFrame();
+	return m_pBackBufferPixels;
+}
+
+void Renderer::SetCameraView(const Vector3& origin, float pitch, float yaw)
+{
+	m_CameraInput = false;
+	m_Camera.SetView(origin, pitch, yaw);
+}
+
+void Renderer::SetCameraLookAt(const Vector3& origin, const Vector3& target)
+{
+	m_CameraInput = false;
+	m_Camera.LookAt(origin, target);
+}
+
+void Renderer::SetCameraFov(float fovAngle)
+{
+	m_CameraInput = false;
+	m_Camera.SetFov(fovAngle);
 }
\ No newline at end of file
@@ -5,6 +5,10 @@
 #include <vector>
 #include "Camera.h"
 #include "DataTypes.h"
+#include "FastMath.h"
+#include "FramePresenter.h"
+#include "FrameWorker.h"
+#include "Scene.h"
 
 struct SDL_Window;
 struct SDL_Surface;
@@ -14,15 +18,43 @@ namespace dae
 	struct Vertex_Out;
 	struct Vertex;
 	struct Mesh;
+	struct PixelBatch;
+	struct ColorRGBx4;
 
 	class Texture;
 	class Timer;
-	class Scene;
+	class JobSystem;
+	class TaskGraph;
+	class ColorOutput;
+
+	enum class DepthFormat
+	{
+		Float32 = 0,		// standard Z, 4 bytes per pixel
+		ReversedFloat32,	// near at 1 and far at 0, 4 bytes per pixel
+		Unorm24,			// standard Z quantized to 24 bits, stored in 4 bytes like D24 without stencil
+		Unorm16				// standard Z quantized to 16 bits, 2 bytes per pixel
+	};
+
+	// seconds spent per stage since the last ResetStageTimes, on whichever thread ran the stage
+	struct StageTimes
+	{
+		double geometry;	// vertex transformation
+		double clear;		// ClearBuffers
+		double raster;		// binning/raster, with the job system also the pending clears and resolve
+		double resolve;		// pending clears, HDR resolve / detile of the serial path
+	};
 
 	class Renderer final
 	{
 	public:
-		Renderer(SDL_Window* pWindow, int width, int height);
+		// A renderer is a render context: camera, targets and render state. Mesh and textures live in a Scene that any
+		// number of contexts on any number of threads can share; it has to outlive them.
+		// pScene null -> the renderer loads and owns the default scene.
+		// One context is used by one thread at a time, the job system may be shared between contexts
+		Renderer(SDL_Window* pWindow, int width, int height, JobSystem* pJobSystem = nullptr, const Scene* pScene = nullptr);
+		// headless: renders into pPixels (width * height, 0x00RRGGBB, rows tightly packed) or an internal buffer if null,
+		// without touching the video subsystem
+		Renderer(int width, int height, uint32_t* pPixels = nullptr, JobSystem* pJobSystem = nullptr, const Scene* pScene = nullptr);
 		~Renderer();
 
 		Renderer(const Renderer&) = delete;
@@ -34,61 +66,251 @@ namespace dae
 
 		void Update(Timer* pTimer);
 		void Render() const;
-		void RenderListMesh(const Mesh& listMesh) const;
-		void RenderStripMesh(const Mesh& stripMesh) const;
+		void RenderFrame() const;
+
+		// with pipelined frames Render returns while the frame is still being rasterized,
+		// anything that changes render state from outside Update has to wait for it first
+		void WaitForFrame() const;
+		// the async present blits and shows frames after they are rendered, reading or replacing the
+		// frame that was last rendered has to wait for it as well; main thread only
+		void WaitForPresent() const;
+		void ClearBuffers();
+		void RenderListMesh(const Mesh& listMesh, const std::vector<Vertex_Out>& vertices_out) const;
+		void RenderStripMesh(const Mesh& stripMesh, const std::vector<Vertex_Out>& vertices_out) const;
 		void RenderTriangle(const Vertex_Out& vertex0, const Vertex_Out& vertex1, const Vertex_Out& vertex2) const;
+		void RenderTriangle(const Vertex_Out& vertex0, const Vertex_Out& vertex1, const Vertex_Out& vertex2, int clipXMin, int clipYMin, int clipXMax, int clipYMax) const;
+		bool GetTriangleBounds(const Vertex_Out& vertex0, const Vertex_Out& vertex1, const Vertex_Out& vertex2, int& xMin, int& yMin, int& xMax, int& yMax) const;
+
+		// job system path for the scene mesh: bin triangles per chunk, rasterize bins, resolve per bin row
+		void RenderListMeshParallel() const;
+		void BinTriangles(int chunkIdx) const;
+		void RenderBin(int binIdx) const;
+		void ResolveBinRow(int binY) const;
+		// raster tasks a width x height frame fans out to, one per bin
+		static int GetNrOfBins(int width, int height) { return ((width + BIN_SIZE - 1) / BIN_SIZE) * ((height + BIN_SIZE - 1) / BIN_SIZE); };
 
 		void PixelShading(const Vertex_Out& v, ColorRGB& color) const;
+		void PixelShading(const PixelBatch& batch, ColorRGBx4& colors) const;
+		void ShadePixelBatch(PixelBatch& batch) const;
+		void WritePixel(int pixelIdx, const ColorRGB& color) const;
+
+		void PrepareTiles(int xMin, int yMin, int xMax, int yMax) const;
+		void ClearTile(int tileX, int tileY, uint8_t clearFlags) const;
+		void ResolvePendingClears() const;
+		void ResolvePendingClears(int tileXMin, int tileYMin, int tileXMax, int tileYMax) const;
+		bool DepthTest(int pixelIdx, float depth) const;
+		void WriteDepth(int pixelIdx, float depth) const;
+		void ClearDepth(int firstPixel, int nrOfPixels) const;
+		void ClearHDRColor(int firstPixel, int nrOfPixels) const;
+		float GetStandardDepth(float depth) const;
+		float GetDepthResolution(float viewDistance) const;
+		int GetDepthBytesPerPixel() const;
+		int PixelIndex(int px, int py) const;
+		void DetileColorBuffer() const;
+		void DetileColorBuffer(int firstRow, int lastRow) const;
+		void ResolveHDRBuffer() const;
+		void ResolveHDRBuffer(int firstRow, int lastRow) const;
+		void ResolveHDRSpan(int firstSourcePixel, int firstTargetPixel, int nrOfPixels) const;
+		void ResolveHeatmap() const;
 
+		void SelectRenderTarget();
+		void SetRenderTarget(SDL_Surface* pRenderTarget);
 		bool SaveBufferToImage() const;
+		bool SaveBufferToImage(const char* path) const;
+		// finished frame, same layout as the headless buffer
+		const uint32_t* GetPixels() const;
+
+		// programmatic camera, disables the mouse/keyboard camera; pitch and yaw in degrees
+		void SetCameraView(const Vector3& origin, float pitch, float yaw);
+		void SetCameraLookAt(const Vector3& origin, const Vector3& target);
+		void SetCameraFov(float fovAngle);
+		// mesh yaw in radians, disables the timer driven rotation
+		void SetMeshRotation(float angle);
+		bool IsHeadless() const { return m_pWindow == nullptr; };
+
+		StageTimes GetStageTimes() const;
+		// bytes held by this context, the shared scene not included
+		size_t GetMemoryFootprint() const;
+		const Scene* GetScene() const { return m_pScene; };
+		void ResetStageTimes();
 
 		void VertexTransformationFunction(const std::vector<Vertex>& vertices_in, std::vector<Vertex_Out>& vertices_out);
+		void TransformVertices(const std::vector<Vertex>& vertices_in, std::vector<Vertex_Out>& vertices_out, int firstVertex, int lastVertex) const;
+
+		enum class ShadingMode
+		{
+			observedArea = 0,
+			diffused,
+			specular,
+			combined
+		};
+
+		enum class SpecularModel
+		{
+			phong = 0,
+			blinnPhong
+		};
 
 		void ToggleDepthBuffer();
+		void CycleHeatmap();
 		void ToggleRotation();
 		void ToggleNormalMap();
 		void CycleShadingMode();
+		void SetShadingMode(ShadingMode shadingMode) { m_MeshShadingMode = shadingMode; };
+		void ToggleSpecularModel();
+		void SetSpecularModel(SpecularModel specularModel) { m_SpecularModel = specularModel; };
+		void CyclePhongPrecision();
+		void ToggleSIMDShading();
+		void CycleToneMapper();
+		void ToggleSRGBEncode();
+		void ToggleHDRTarget();
+		void AdjustExposure(float stops);
+		void ToggleLazyClear();
+		void ToggleTiledLayout();
+		void ToggleZeroCopyPresent();
+		void ToggleAsyncPresent();
+		void TogglePresentPolicy();
+		void TogglePipelinedFrames();
+		void ToggleJobSystem();
+		float GetPipelineOverlap() const;
+		void CycleDepthFormat();
+		void SetDepthFormat(DepthFormat depthFormat);
+		DepthFormat GetDepthFormat() const { return m_DepthFormat; };
 
 
 		float Remap(float v, float min, float max) const;
 
 	private:
-		SDL_Window* m_pWindow;
+		void Initialize();
+		void UpdateTargetAllocations();
+
+		SDL_Window* m_pWindow; // null when headless
 
 		SDL_Surface* m_pFrontBuffer;
 		SDL_Surface* m_pBackBuffer;
-		uint32_t* m_pBackBufferPixels;
 
-		Mesh m_TriangleListMesh;
+		// surface that gets rasterized into: the window surface itself when its layout matches (no blit), else m_pBackBuffer
+		SDL_Surface* m_pRenderTarget;
+		uint32_t* m_pBackBufferPixels; // pixels of m_pRenderTarget
+		bool m_CanPresentDirect;
+
+		// async present, owns the ring of frames rendered into while it is enabled
+		FramePresenter* m_pPresenter;
+		ColorOutput* m_pColorOutput;
+
+		// tiled layout: color is rasterized into m_pTiledColorPixels and detiled into the backbuffer at present,
+		// allocated while enabled
+		uint32_t* m_pTiledColorPixels;
+		uint32_t* m_pColorTargetPixels;
+
+		// mesh and textures, shared between renderers; m_pOwnedScene is set when this renderer loaded it itself
+		const Scene* m_pScene;
+		Scene* m_pOwnedScene;
+
+		// per renderer state of the scene mesh
+		Matrix m_WorldMatrix{};
+		std::vector<Vertex_Out> m_VerticesOut{};
+
+		// per-frame constants, snapshotted in Update before the geometry stage runs
+		struct FrameConstants
+		{
+			Matrix worldMatrix;
+			Matrix worldViewProjectionMatrix;	// view directions
+			Matrix positionMatrix;				// positions, reversed Z projection when that depth format is used
+		};
+		FrameConstants m_FrameConstants{};
+
+		// geometry of the next frame is written here while the current vertices_out may still be rasterized
+		std::vector<Vertex_Out> m_NextVerticesOut{};
+
+		// job system owned by the application, null -> everything runs on the calling thread
+		JobSystem* m_pJobSystem;
+		TaskGraph* m_pFrameGraph;
+
+		// BIN_SIZE x BIN_SIZE pixel bins, the unit of parallel rasterization, whole lazy clear tiles so bins never share one
+		static constexpr int BIN_SIZE{ 64 };
+		static constexpr int BINNING_GRAIN{ 1024 };	// triangles per binning task
+		static constexpr int VERTEX_GRAIN{ 1024 };	// vertices per vertex stage task
+		int m_NrOfBinsX;
+		int m_NrOfBinsY;
+		int m_NrOfBinningChunks;
+		std::vector<uint32_t>* m_pBinnedTriangles; // triangle indices per binning chunk per bin, in submission order
+
+		// pipelined frames, rasterizes the submitted frame while the next Update runs
+		FrameWorker* m_pFrameWorker;
+		mutable StageTimes m_StageTimes{}; // raster and resolve get written by the const RenderFrame
+		double m_GeometryTime{};
+		double m_OverlappedGeometryTime{};
 		Matrix m_MeshTranslationMatrix{};
 		Matrix m_MeshRotationMatrix{};
 		float m_MeshRotateAngle{};
 
-		Texture* m_pDiffuseTexture;
-		Texture* m_pNormalMapTexture; 
-		Texture* m_pGlossTexture;
-		Texture* m_pSpecularTexture;
+		// owned by m_pScene
+		const Texture* m_pDiffuseTexture;
+		const Texture* m_pNormalMapTexture;
+		const Texture* m_pGlossTexture;
+		const Texture* m_pSpecularTexture;
 
+		// one buffer per depth format, only the one of m_DepthFormat is allocated
 		float* m_pDepthBufferPixels;
+		uint32_t* m_pDepth24BufferPixels;
+		uint16_t* m_pDepth16BufferPixels;
+
+		// HDR color target, planar R, G and B floats (m_NrOfBufferPixels each), allocated while enabled
+		float* m_pHDRBufferPixels;
+
+		// per pixel depth tests, shades or cycles of the frame for the heatmap view, same layout as the depth buffer,
+		// allocated while enabled
+		uint32_t* m_pHeatmapPixels;
+
+		// TILE_SIZE x TILE_SIZE pixel tiles, used by the lazy clear and the tiled layout
+		static constexpr int TILE_SIZE{ 8 };
+		static_assert(BIN_SIZE % TILE_SIZE == 0);
+		enum TileFlags : uint8_t
+		{
+			tilePendingDepth = 1 << 0,	// depth has to be cleared before use
+			tilePendingColor = 1 << 1,	// color has to be cleared before use or present
+			tileColorIsClear = 1 << 2	// color already holds the clear value
+		};
+		uint8_t* m_pTileFlags;
+		int m_NrOfTilesX;
+		int m_NrOfTilesY;
+		uint32_t m_ClearColor;
+		// m_ClearColor in the HDR target; the resolve packs pixels still holding it as m_ClearColor, so the background
+		// doesn't change with exposure, tone mapper or sRGB encode, same as without the HDR target
+		ColorRGB m_HDRClearColor;
 
 		Camera m_Camera{};
 
 		const int m_Width;
 		const int m_Height;
 		const int m_NrOfPixels;
+		int m_NrOfBufferPixels; // m_NrOfPixels padded up to whole tiles
 
 		// inputs
-		enum class ShadingMode
+		enum class HeatmapMode
 		{
-			observedArea = 0,
-			diffused,
-			specular,
-			combined
+			off = 0,
+			depthTests,
+			shaded,
+			cycles
 		};
+		bool m_CameraInput{ true };
 		bool m_MeshDepthBuffer{ false };
+		HeatmapMode m_HeatmapMode{ HeatmapMode::off };
 		bool m_MeshRotating{ true };
 		bool m_MeshNormalMap{ true };
 		ShadingMode m_MeshShadingMode{ ShadingMode::combined };
+		SpecularModel m_SpecularModel{ SpecularModel::phong };
+		PowPrecision m_PhongPrecision{ PowPrecision::Exact };
+		bool m_SIMDShading{ true };
+		bool m_HDRTarget{ false };
+		bool m_LazyClear{ true };
+		bool m_TiledLayout{ false };
+		bool m_ZeroCopyPresent{ true };
+		PresentPolicy m_PresentPolicy{ PresentPolicy::Block };
+		DepthFormat m_DepthFormat{ DepthFormat::Float32 };
+		bool m_UseJobSystem{ true };
 	};
 }
 
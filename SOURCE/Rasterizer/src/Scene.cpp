@@ -0,0 +1,126 @@
+//External includes
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+//Project includes
+#include "Scene.h"
+#include "JobSystem.h"
+#include "Texture.h"
+#include "Utils.h"
+
+using namespace dae;
+
+bool SceneFiles::CanOpen() const
+{
+	for (const std::string* pPath : { &mesh, &diffuse, &normalMap, &gloss, &specular })
+	{
+		if (!std::ifstream{ *pPath, std::ios::binary }.good())
+		{
+			std::cout << "Can't open " << *pPath << "\n";
+			return false;
+		}
+	}
+	return true;
+}
+
+Scene::Scene(const SceneFiles& files, JobSystem* pJobSystem, int nrOfInstances)
+{
+	// create mesh
+	m_Mesh.primitiveTopology = PrimitiveTopology::TriangleList;
+	Utils::ParseOBJ(files.mesh, m_Mesh.vertices, m_Mesh.indices);
+	if (nrOfInstances > 1) CreateInstances(nrOfInstances);
+
+	// Textures, decoded in parallel when there is a job system
+	TaskGraph textureGraph{};
+	textureGraph.AddTask([this, &files] { m_pDiffuseTexture = Texture::LoadFromFile(files.diffuse); });
+	textureGraph.AddTask([this, &files] { m_pNormalMapTexture = Texture::LoadFromFile(files.normalMap); });
+	textureGraph.AddTask([this, &files] { m_pGlossTexture = Texture::LoadFromFile(files.gloss); });
+	textureGraph.AddTask([this, &files] { m_pSpecularTexture = Texture::LoadFromFile(files.specular); });
+
+	if (pJobSystem)
+	{
+		pJobSystem->Run(textureGraph);
+	}
+	else
+	{
+		JobSystem serialJobSystem{ 0 };
+		serialJobSystem.Run(textureGraph);
+	}
+
+	// check textures
+	assert(m_pDiffuseTexture != nullptr);
+	assert(m_pNormalMapTexture != nullptr);
+	assert(m_pGlossTexture != nullptr);
+	assert(m_pSpecularTexture != nullptr);
+}
+
+Scene::~Scene()
+{
+	// textures
+	if (m_pDiffuseTexture) delete m_pDiffuseTexture;
+	if (m_pNormalMapTexture) delete m_pNormalMapTexture;
+	if (m_pGlossTexture) delete m_pGlossTexture;
+	if (m_pSpecularTexture) delete m_pSpecularTexture;
+}
+
+void Scene::CreateInstances(int nrOfInstances)
+{
+	if (m_Mesh.vertices.empty()) return;
+
+	// footprint of one instance on the ground plane, with some room in between
+	const auto [minX, maxX] { std::minmax_element(m_Mesh.vertices.begin(), m_Mesh.vertices.end(),
+		[](const Vertex& a, const Vertex& b) { return a.position.x < b.position.x; }) };
+	const auto [minZ, maxZ] { std::minmax_element(m_Mesh.vertices.begin(), m_Mesh.vertices.end(),
+		[](const Vertex& a, const Vertex& b) { return a.position.z < b.position.z; }) };
+	constexpr float spacing{ 1.2f };
+	const float cellWidth{ (maxX->position.x - minX->position.x) * spacing };
+	const float cellDepth{ (maxZ->position.z - minZ->position.z) * spacing };
+
+	// as square as possible, the last row may be partly filled
+	const int nrOfColumns{ static_cast<int>(std::ceil(std::sqrt(static_cast<float>(nrOfInstances)))) };
+	const int nrOfRows{ (nrOfInstances + nrOfColumns - 1) / nrOfColumns };
+
+	const std::vector<Vertex> vertices{ m_Mesh.vertices };
+	const std::vector<uint32_t> indices{ m_Mesh.indices };
+	const uint32_t nrOfVertices{ static_cast<uint32_t>(vertices.size()) };
+	m_Mesh.vertices.clear();
+	m_Mesh.indices.clear();
+	m_Mesh.vertices.reserve(vertices.size() * nrOfInstances);
+	m_Mesh.indices.reserve(indices.size() * nrOfInstances);
+
+	for (int instanceIdx{}; instanceIdx < nrOfInstances; ++instanceIdx)
+	{
+		const Vector3 offset
+		{
+			(instanceIdx % nrOfColumns - (nrOfColumns - 1) * 0.5f) * cellWidth,
+			0.f,
+			(instanceIdx / nrOfColumns - (nrOfRows - 1) * 0.5f) * cellDepth
+		};
+
+		for (Vertex vertex : vertices)
+		{
+			vertex.position += offset;
+			m_Mesh.vertices.push_back(vertex);
+		}
+
+		const uint32_t firstVertex{ nrOfVertices * instanceIdx };
+		for (const uint32_t index : indices)
+		{
+			m_Mesh.indices.push_back(firstVertex + index);
+		}
+	}
+}
+
+size_t Scene::GetMemoryFootprint() const
+{
+	return
+		m_Mesh.vertices.capacity() * sizeof(Vertex) +
+		m_Mesh.indices.capacity() * sizeof(uint32_t) +
+		m_pDiffuseTexture->GetSizeInBytes() +
+		m_pNormalMapTexture->GetSizeInBytes() +
+		m_pGlossTexture->GetSizeInBytes() +
+		m_pSpecularTexture->GetSizeInBytes();
+}
@@ -0,0 +1,63 @@
+#ifndef SCENE_H
+#define SCENE_H
+
+#include <string>
+#include "DataTypes.h"
+
+namespace dae
+{
+	class Texture;
+	class JobSystem;
+
+	// files a Scene loads, the vehicle by default
+	struct SceneFiles
+	{
+		std::string mesh{ "Resources/vehicle.obj" };
+		std::string diffuse{ "Resources/vehicle_diffuse.png" };
+		std::string normalMap{ "Resources/vehicle_normal.png" };
+		std::string gloss{ "Resources/vehicle_gloss.png" };
+		std::string specular{ "Resources/vehicle_specular.png" };
+
+		// a missing file would only show up as a crash halfway through loading;
+		// prints the first one that can't be opened
+		bool CanOpen() const;
+	};
+
+	// Mesh and textures, read-only once loaded so any number of renderers on any number of threads can share one
+	class Scene final
+	{
+	public:
+		// textures are decoded as parallel tasks when there is a job system.
+		// nrOfInstances > 1 repeats the mesh on a grid centered on the origin, merged into one mesh sharing the textures
+		explicit Scene(const SceneFiles& files = SceneFiles{}, JobSystem* pJobSystem = nullptr, int nrOfInstances = 1);
+		~Scene();
+
+		Scene(const Scene&) = delete;
+		Scene(Scene&&) noexcept = delete;
+		Scene& operator=(const Scene&) = delete;
+		Scene& operator=(Scene&&) noexcept = delete;
+
+		// vertices, indices and topology, vertices_out and worldMatrix belong to the renderers
+		const Mesh& GetMesh() const { return m_Mesh; };
+
+		const Texture* GetDiffuseTexture() const { return m_pDiffuseTexture; };
+		const Texture* GetNormalMapTexture() const { return m_pNormalMapTexture; };
+		const Texture* GetGlossTexture() const { return m_pGlossTexture; };
+		const Texture* GetSpecularTexture() const { return m_pSpecularTexture; };
+
+		// bytes held by the mesh and the textures
+		size_t GetMemoryFootprint() const;
+
+	private:
+		void CreateInstances(int nrOfInstances);
+
+		Mesh m_Mesh{};
+
+		Texture* m_pDiffuseTexture{};
+		Texture* m_pNormalMapTexture{};
+		Texture* m_pGlossTexture{};
+		Texture* m_pSpecularTexture{};
+	};
+}
+
+#endif // !SCENE_H
@@ -1,5 +1,6 @@
 //Standard includes
 #include <iostream>
+#include <string>
 
 //External includes
 #ifdef _DEBUG
@@ -15,14 +16,159 @@
 //Project includes
 #include "Timer.h"
 #include "Renderer.h"
+#include "Benchmark.h"
+#include "CommandLine.h"
+#include "GoldenImages.h"
+#include "JobSystem.h"
+#include "Offline.h"
+#include "PipelineStats.h"
+#include "Trace.h"
 
 using namespace dae;
 
-int main()
+int main(int argc, char* argv[])
 {
+	// --threads N (0 -> single threaded) and --pin to pin the job system workers to cores,
+	// --trace-frames N for the frames a trace capture (V) records
+	int nrOfWorkers{ -1 };
+	bool pinWorkers{ false };
+	int nrOfTraceFrames{ 30 };
+	for (int argIdx{ 1 }; argIdx < argc; ++argIdx)
+	{
+		const std::string argument{ argv[argIdx] };
+		bool isValid{ true };
+		if (argument == "--threads" && argIdx + 1 < argc) isValid = CommandLine::ParseValue(argv[++argIdx], nrOfWorkers);
+		else if (argument == "--pin") pinWorkers = true;
+		else if (argument == "--trace-frames" && argIdx + 1 < argc) isValid = CommandLine::ParseValue(argv[++argIdx], nrOfTraceFrames);
+
+		if (!isValid)
+		{
+			std::cout << "Invalid value for " << argument << ": " << argv[argIdx] << "\n";
+			return 1;
+		}
+	}
+	Trace::SetThreadName("Main");
+
+	// --headless [frames] [width height], never initializes the video subsystem
+	if (argc > 1 && std::string{ argv[1] } == "--headless")
+	{
+		int nrOfFrames{ 100 };
+		int frameWidth{ 640 };
+		int frameHeight{ 480 };
+		bool isValid{ true };
+		if (argc > 2 && argv[2][0] != '-') isValid = CommandLine::ParseValue(argv[2], nrOfFrames);
+		if (argc > 4 && argv[3][0] != '-')
+		{
+			isValid = CommandLine::ParseValue(argv[3], frameWidth) && isValid;
+			isValid = CommandLine::ParseValue(argv[4], frameHeight) && isValid;
+		}
+
+		if (!isValid || nrOfFrames <= 0 || frameWidth <= 0 || frameHeight <= 0)
+		{
+			std::cout << "--headless [frames] [width height]\n";
+			return 1;
+		}
+
+		JobSystem* pJobSystem{ new JobSystem{ nrOfWorkers, pinWorkers } };
+		const bool isRun{ Offline::RunHeadless(nrOfFrames, frameWidth, frameHeight, pJobSystem) };
+		delete pJobSystem;
+		return isRun ? 0 : 1;
+	}
+
+	// --batch [options], image sequence without a window, see Offline::ParseBatchSettings
+	if (argc > 1 && std::string{ argv[1] } == "--batch")
+	{
+		Offline::BatchSettings settings{};
+		if (!Offline::ParseBatchSettings(argc, argv, settings)) return 1;
+
+		JobSystem* pJobSystem{ new JobSystem{ nrOfWorkers, pinWorkers } };
+		const bool isRun{ Offline::RunBatch(settings, pJobSystem) };
+		delete pJobSystem;
+		return isRun ? 0 : 1;
+	}
+
+	// --bench [options], deterministic headless frame benchmark with a JSON report
+	if (argc > 1 && std::string{ argv[1] } == "--bench")
+	{
+		Benchmark::FrameBenchmarkSettings settings{};
+		if (!Benchmark::ParseFrameBenchmarkSettings(argc, argv, settings)) return 1;
+
+		JobSystem* pJobSystem{ new JobSystem{ nrOfWorkers, pinWorkers } };
+		const bool isRun{ Benchmark::RunFrameBenchmark(settings, pJobSystem) };
+		delete pJobSystem;
+		return isRun ? 0 : 1;
+	}
+
+	// --check-alloc [options], same options as --bench, fails if a frame after the warm-up allocates;
+	// needs ENABLE_ALLOCATION_TRACKING, build the Profile|x64 configuration or see AllocationTracker.h
+	if (argc > 1 && std::string{ argv[1] } == "--check-alloc")
+	{
+		Benchmark::FrameBenchmarkSettings settings{};
+		if (!Benchmark::ParseFrameBenchmarkSettings(argc, argv, settings)) return 1;
+
+		JobSystem* pJobSystem{ new JobSystem{ nrOfWorkers, pinWorkers } };
+		const bool isClean{ Benchmark::RunAllocationCheck(settings, pJobSystem) };
+		delete pJobSystem;
+		return isClean ? 0 : 1;
+	}
+
+	// --golden [options], image regression test against the committed references, see GoldenImages::ParseSettings
+	if (argc > 1 && std::string{ argv[1] } == "--golden")
+	{
+		GoldenImages::Settings settings{};
+		if (!GoldenImages::ParseSettings(argc, argv, settings)) return 1;
+
+		JobSystem* pJobSystem{ new JobSystem{ nrOfWorkers, pinWorkers } };
+		const bool isPassed{ GoldenImages::Run(settings, pJobSystem) };
+		delete pJobSystem;
+		return isPassed ? 0 : 1;
+	}
+
+	// --sweep [options], resolution x instances x workers, creates its own job systems
+	if (argc > 1 && std::string{ argv[1] } == "--sweep")
+	{
+		Benchmark::SweepSettings settings{};
+		if (!Benchmark::ParseSweepSettings(argc, argv, settings)) return 1;
+		return Benchmark::RunSweep(settings) ? 0 : 1;
+	}
+
+	// --bench-math [operations], math micro-benchmarks, nothing gets rendered
+	if (argc > 1 && std::string{ argv[1] } == "--bench-math")
+	{
+		int nrOfOperations{ 1 << 16 };
+		if ((argc > 2 && !CommandLine::ParseValue(argv[2], nrOfOperations)) || nrOfOperations <= 0)
+		{
+			std::cout << "--bench-math [operations]\n";
+			return 1;
+		}
+
+		Benchmark::RunMathBenchmark(nrOfOperations);
+		return 0;
+	}
+
 	//Create window + surfaces
 	SDL_Init(SDL_INIT_VIDEO);
 
+	// command line modes
+	if (argc > 1 && std::string{ argv[1] } == "--bench-clear")
+	{
+		int nrOfFrames{ 100 };
+		const bool isValid{ (argc <= 2 || CommandLine::ParseValue(argv[2], nrOfFrames)) && nrOfFrames > 0 };
+		if (isValid) Benchmark::RunClearBenchmark(nrOfFrames);
+		else std::cout << "--bench-clear [frames]\n";
+		SDL_Quit();
+		return isValid ? 0 : 1;
+	}
+	if (argc > 1 && std::string{ argv[1] } == "--bench-depth")
+	{
+		int nrOfFrames{ 100 };
+		const bool isValid{ (argc <= 2 || CommandLine::ParseValue(argv[2], nrOfFrames)) && nrOfFrames > 0 };
+		if (isValid) Benchmark::RunDepthFormatBenchmark(nrOfFrames);
+		else std::cout << "--bench-depth [frames]\n";
+		SDL_Quit();
+		return isValid ? 0 : 1;
+	}
+
 	constexpr uint32_t width{ 640 };
 	constexpr uint32_t height{ 480 };
 
@@ -41,16 +187,19 @@ int main()
 
 	//Initialize "framework"
 	Timer* pTimer{ new Timer{} };
-	Renderer* pRenderer{ new Renderer{ pWindow, width, height } };
+	JobSystem* pJobSystem{ new JobSystem{ nrOfWorkers, pinWorkers } };
+	Renderer* pRenderer{ new Renderer{ pWindow, width, height, pJobSystem } };
 
 	//Start loop
 	pTimer->Start();
 
 	float printTimer{};
+	int nrOfPrintFrames{};
 	bool showFPS{ true };
 	bool isLooping{ true };
 	bool takeScreenshot{ false };
 	bool clearConsole{ false };
+	int nrOfFramesToTrace{};
 
 	SDL_Event e;
 
@@ -65,6 +214,9 @@ int main()
 				isLooping = false;
 				break;
 			case SDL_KEYUP:
+				// a pipelined frame may still be rasterizing
+				pRenderer->WaitForFrame();
+
 				switch (e.key.keysym.scancode)
 				{
 				case SDL_SCANCODE_X:
@@ -75,6 +227,10 @@ int main()
 					clearConsole = !clearConsole;
 					break;
 
+				case SDL_SCANCODE_F3:
+					pRenderer->CycleHeatmap();
+					break;
+
 				case SDL_SCANCODE_F4:
 					pRenderer->ToggleDepthBuffer();
 					break;
@@ -91,9 +247,85 @@ int main()
 					pRenderer->CycleShadingMode();
 					break;
 
+				case SDL_SCANCODE_B:
+					pRenderer->ToggleSpecularModel();
+					break;
+
+				case SDL_SCANCODE_F8:
+					pRenderer->CyclePhongPrecision();
+					break;
+
+				case SDL_SCANCODE_F9:
+					pRenderer->ToggleSIMDShading();
+					break;
+
+				case SDL_SCANCODE_F10:
+					pRenderer->CycleToneMapper();
+					break;
+
+				case SDL_SCANCODE_F11:
+					pRenderer->ToggleSRGBEncode();
+					break;
+
+				case SDL_SCANCODE_F12:
+					pRenderer->ToggleHDRTarget();
+					break;
+
+				case SDL_SCANCODE_PAGEUP:
+					pRenderer->AdjustExposure(0.5f);
+					break;
+
+				case SDL_SCANCODE_PAGEDOWN:
+					pRenderer->AdjustExposure(-0.5f);
+					break;
+
+				case SDL_SCANCODE_L:
+					pRenderer->ToggleLazyClear();
+					break;
+
+				case SDL_SCANCODE_K:
+					pRenderer->ToggleTiledLayout();
+					break;
+
+				case SDL_SCANCODE_Z:
+					pRenderer->CycleDepthFormat();
+					break;
+
+				case SDL_SCANCODE_P:
+					pRenderer->ToggleZeroCopyPresent();
+					break;
+
+				case SDL_SCANCODE_O:
+					pRenderer->ToggleAsyncPresent();
+					break;
+
+				case SDL_SCANCODE_I:
+					pRenderer->TogglePresentPolicy();
+					break;
+
+				case SDL_SCANCODE_U:
+					pRenderer->TogglePipelinedFrames();
+					break;
+
+				case SDL_SCANCODE_J:
+					pRenderer->ToggleJobSystem();
+					break;
+
 				case SDL_SCANCODE_F:
 					showFPS = !showFPS;
 					break;
+
+				case SDL_SCANCODE_H:
+					pTimer->GetFrameTimeHistogram().Print();
+					std::cout << (pTimer->GetFrameTimeHistogram().ExportCSV("frametimes.csv") ? "Frame time histogram saved to frametimes.csv\n" : "Something went wrong. Frame time histogram not saved!\n");
+					break;
+
+				case SDL_SCANCODE_V:
+					if (nrOfFramesToTrace > 0 || nrOfTraceFrames <= 0) break;
+					nrOfFramesToTrace = nrOfTraceFrames;
+					Trace::BeginCapture();
+					std::cout << "Trace: capturing " << nrOfTraceFrames << " frames\n";
+					break;
 				}
 				break;
 			}
@@ -107,16 +339,33 @@ int main()
 
 		//--------- Timer ---------
 		pTimer->Update();
+		if (showFPS && pTimer->GetFrameTimeHistogram().IsLastFrameHitch())
+		{
+			std::cout << "Hitch: " << pTimer->GetElapsed() * 1000.f << " ms\n";
+		}
+
+		//--------- Trace ---------
+		if (nrOfFramesToTrace > 0 && --nrOfFramesToTrace == 0)
+		{
+			// the capture gets read from every thread's buffer, the last frame has to be rendered and presented
+			pRenderer->WaitForPresent();
+			Trace::EndCapture();
+			std::cout << (Trace::WriteCapture("trace.json") ? "Trace saved to trace.json\n" : "Something went wrong. Trace not saved!\n");
+		}
 
 		// fps
 		if (showFPS)
 		{
 			printTimer += pTimer->GetElapsed();
+			++nrOfPrintFrames;
 			if (printTimer >= 1.f)
 			{
 				printTimer = 0.f;
 				if (clearConsole) { std::cout << "\x1B[2J\x1B[H"; }
 				std::cout << "dFPS: " << pTimer->GetdFPS() << "\n";
+
+				if constexpr (Stats::IS_ENABLED) Stats::Print(Stats::Collect(), nrOfPrintFrames, width * height);
+				nrOfPrintFrames = 0;
 			}
 		}
 
@@ -136,11 +385,13 @@ int main()
 	}
 	pTimer->Stop();
 
-	SDL_DestroyWindow(pWindow);
-	SDL_Quit();
-
+	// renderer first, its present thread may still be using the window
 	delete pTimer;
 	delete pRenderer;
+	delete pJobSystem;
+
+	SDL_DestroyWindow(pWindow);
+	SDL_Quit();
 
 	return 0;
 }
\ No newline at end of file